@@ -38,6 +38,10 @@ DifferentialDrive motors(
 
 void setup() {
   motors.init();
+  // Optional: drive the motors at 20 kHz (inaudible) instead of the default ~490 Hz.
+  // Only works when both PWM pins are Timer1 pins (9 and 10 on an Uno), listed left 
+  // then right like in the constructor; returns false (and keeps ~490 Hz) otherwise.
+  motors.useTimerPWM<leftMotorPWMPin, rightMotorPWMPin, 20000>();
 }
 
 void loop() {
@@ -0,0 +1,48 @@
+/*
+
+  SSBotConfig.cpp - Versioned, CRC-checked robot configuration in EEPROM.
+
+*/
+
+#include <EEPROM.h>
+#include <SSBotConfig.hpp>
+
+using namespace SummerSpringBot;
+
+// CRC-8, polynomial 0x07
+uint8_t SummerSpringBot::crc8(const uint8_t* data, size_t len) {
+    uint8_t crc = 0;
+    while (len--) {
+        crc ^= *data++;
+        for (uint8_t i = 0; i < 8; i++)
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : (crc << 1);
+    }
+    return crc;
+}
+
+bool SummerSpringBot::loadRobotConfig(RobotConfig& config) {
+    RobotConfig stored;
+    uint8_t *b = (uint8_t*) &stored;
+    for (size_t i = 0; i < sizeof(stored); i++)
+        b[i] = EEPROM.read(ROBOT_CONFIG_ADDRESS + i);
+
+    if (stored.version != ROBOT_CONFIG_VERSION)
+        return false;
+    if (stored.crc != crc8(b, offsetof(RobotConfig, crc)))
+        return false;
+
+    config = stored;
+    return true;
+}
+
+void SummerSpringBot::saveRobotConfig(RobotConfig& config) {
+    config.version = ROBOT_CONFIG_VERSION;
+    config.crc = crc8((const uint8_t*) &config, offsetof(RobotConfig, crc));
+    const uint8_t *b = (const uint8_t*) &config;
+    for (size_t i = 0; i < sizeof(config); i++)
+        EEPROM.update(ROBOT_CONFIG_ADDRESS + i, b[i]); // update() skips unchanged bytes to save EEPROM wear
+}
+
+void SummerSpringBot::eraseRobotConfig() {
+    EEPROM.update(ROBOT_CONFIG_ADDRESS, 0xFF);
+}
@@ -0,0 +1,49 @@
+#ifndef SSBOT_CONFIG_H
+#define SSBOT_CONFIG_H
+
+#include <Arduino.h>
+
+namespace SummerSpringBot {
+
+// Robot tuning stored in EEPROM, so it can be changed without reflashing.
+// Motor, DualMotors, DifferentialDrive, Sonar and IRSensor load it in init(); if
+// nothing valid is stored, they keep the values passed to their constructors.
+
+// bump this whenever RobotConfig changes layout -- old EEPROM contents are then ignored
+const uint8_t ROBOT_CONFIG_VERSION = 2;
+const int ROBOT_CONFIG_ADDRESS = 0;
+
+// remote buttons that can be remapped (index into RobotConfig::keymap)
+enum RemoteKey {
+    KEY_FWD,
+    KEY_REV,
+    KEY_LEFT,
+    KEY_RIGHT,
+    KEY_STOP,
+    KEY_ENABLE,
+    NUM_REMOTE_KEYS
+};
+
+// IR address meaning "listen to every remote"
+const uint16_t IR_ANY_ADDRESS = 0xFFFF;
+
+struct RobotConfig {
+    uint8_t version;
+    uint8_t leftMaxPWM, rightMaxPWM;    // 0-255
+    uint8_t defaultSpeed;               // 0-100
+    uint16_t clearanceThreshold;        // cm
+    uint8_t keymap[NUM_REMOTE_KEYS];    // IRCommand for each RemoteKey
+    uint16_t irAddress;                 // NEC address of our remote, or IR_ANY_ADDRESS
+    uint8_t crc;                        // CRC-8 of everything above
+};
+
+// returns false (and leaves config untouched) if EEPROM holds no valid config
+bool loadRobotConfig(RobotConfig& config);
+// stamps version and CRC, then writes only the bytes that changed
+void saveRobotConfig(RobotConfig& config);
+void eraseRobotConfig();
+uint8_t crc8(const uint8_t* data, size_t len);
+
+} // end of SummerSpringBot namespace
+
+#endif
@@ -0,0 +1,59 @@
+/*
+
+  SSBotFootprint.cpp - Stack high-water mark and free RAM on AVR.
+
+*/
+
+#include <SSBotFootprint.hpp>
+
+using namespace SummerSpringBot;
+
+#ifdef __AVR__
+
+#define STACK_PAINT 0xC5
+
+extern uint8_t _end;        // end of static variables (start of heap)
+extern uint8_t __stack;     // top of RAM
+extern char *__brkval;      // top of heap, 0 if malloc() was never used
+
+// Runs before main() and before the stack is in use, so it is plain assembly: 
+// fill everything from _end to __stack with STACK_PAINT. Costs ~0.5ms at boot.
+void _paintStack(void) __attribute__ ((naked, used, section(".init1")));
+void _paintStack(void) {
+    __asm volatile (
+        "    ldi r30, lo8(_end)       \n"
+        "    ldi r31, hi8(_end)       \n"
+        "    ldi r24, %0              \n"
+        "    ldi r25, hi8(__stack)    \n"
+        "    rjmp 2f                  \n"
+        "1:  st Z+, r24               \n"
+        "2:  cpi r30, lo8(__stack)    \n"
+        "    cpc r31, r25             \n"
+        "    brlo 1b                  \n"
+        "    breq 1b                  \n"
+        :: "M" (STACK_PAINT)
+    );
+}
+
+uint16_t SummerSpringBot::stackUnused() {
+    // heap allocations overwrite the paint from below, so start counting above the heap
+    const uint8_t *p = __brkval ? (const uint8_t*) __brkval : &_end;
+    uint16_t count = 0;
+    while (*p == STACK_PAINT && p <= &__stack) {
+        p++;
+        count++;
+    }
+    return count;
+}
+
+int SummerSpringBot::freeRAM() {
+    uint8_t top;
+    return &top - (__brkval ? (uint8_t*) __brkval : &_end);
+}
+
+#else
+
+uint16_t SummerSpringBot::stackUnused() { return 0; }
+int SummerSpringBot::freeRAM() { return 0; }
+
+#endif
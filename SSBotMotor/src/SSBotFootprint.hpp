@@ -0,0 +1,29 @@
+#ifndef SSBOT_FOOTPRINT_H
+#define SSBOT_FOOTPRINT_H
+
+#include <Arduino.h>
+
+namespace SummerSpringBot {
+
+// RAM budget for one object of each class on AVR, in bytes. Each class's .cpp 
+// static_asserts against these, so the build fails if a class outgrows its budget. 
+// Only raise a budget on purpose -- an Uno has 2048 bytes of RAM in total.
+const size_t MOTOR_SIZE_BUDGET              = 9;
+const size_t DUAL_MOTORS_SIZE_BUDGET        = 2 * MOTOR_SIZE_BUDGET;
+const size_t DIFFERENTIAL_DRIVE_SIZE_BUDGET = 2 * MOTOR_SIZE_BUDGET + 5;
+const size_t SONAR_SIZE_BUDGET              = 15;   // not counting its NewPing
+const size_t IR_SENSOR_SIZE_BUDGET          = 12;
+const size_t MOTION_SCRIPT_SIZE_BUDGET      = 22;
+const size_t SPEED_GOVERNOR_SIZE_BUDGET     = 23;
+const size_t LINE_SENSOR_ARRAY_SIZE_BUDGET  = 51;   // mostly calibration for 8 sensors
+const size_t BATTERY_SIZE_BUDGET            = 17;
+
+// Stack usage: RAM between the heap and the stack is painted with a marker byte 
+// at reset, so stackUnused() tells how close the stack has ever come to the heap 
+// (the high-water mark). freeRAM() is the gap right now.
+uint16_t stackUnused();
+int freeRAM();
+
+} // end of SummerSpringBot namespace
+
+#endif
@@ -0,0 +1,47 @@
+/*
+
+  SSBotLog.cpp - Compact binary logging for SSBot. Decode with tools/ssbot_log.py.
+
+*/
+
+#include <SSBotLog.hpp>
+#include <SSBotConfig.hpp> // crc8()
+
+using namespace SummerSpringBot;
+
+Logger::Logger(Print& out) : _out(out) { }
+
+void Logger::log(LogID id) {
+    _send(id, NULL, 0);
+}
+
+void Logger::log(LogID id, int16_t arg0) {
+    int16_t args[] = {arg0};
+    _send(id, args, 1);
+}
+
+void Logger::log(LogID id, int16_t arg0, int16_t arg1) {
+    int16_t args[] = {arg0, arg1};
+    _send(id, args, 2);
+}
+
+void Logger::log(LogID id, int16_t arg0, int16_t arg1, int16_t arg2) {
+    int16_t args[] = {arg0, arg1, arg2};
+    _send(id, args, 3);
+}
+
+void Logger::_send(LogID id, const int16_t* args, uint8_t argc) {
+    // build the whole frame first so it goes out in a single write()
+    uint8_t frame[4 + 2*LOG_MAX_ARGS];
+    uint8_t *f = frame;
+    *f++ = LOG_SYNC_BYTE;
+    *f++ = id;
+    *f++ = argc;
+    for (uint8_t i = 0; i < argc; i++) {
+        *f++ = (uint8_t) args[i];
+        *f++ = (uint8_t) (args[i] >> 8);
+    }
+    *f = crc8(frame + 1, f - frame - 1);
+    f++;
+    _out.write(frame, f - frame);
+}
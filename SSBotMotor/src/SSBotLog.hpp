@@ -0,0 +1,55 @@
+#ifndef SSBOT_LOG_H
+#define SSBOT_LOG_H
+
+#include <Arduino.h>
+
+namespace SummerSpringBot {
+
+// Deferred-formatting logger: instead of formatting text on the Arduino, each log
+// site sends a 1-byte message ID plus its raw arguments, and tools/ssbot_log.py
+// turns the stream back into text on the computer.
+//
+// Frame layout:  SYNC | id | argc | argc x int16 (little-endian) | CRC-8
+// The CRC covers everything after SYNC, so the decoder can tell a real frame from 
+// a stray SYNC byte when bytes get dropped.
+//
+// Message table -- X(id, format). Placeholders in the format are filled in order
+// from the arguments: {d} = number, {button} = IRCommand,
+// {state} = DifferentialDrive::MotorState, {enabled} = bool, and {u32} = unsigned 
+// 32-bit number sent as two arguments, low half first.
+// Only ever ADD messages to the END of this list, otherwise old logs decode wrong.
+#define SSBOT_LOG_MESSAGES(X) \
+    X(LOG_SERIAL_READY,         "Serial communication ready.") \
+    X(LOG_REMOTE_BUTTON,        "[REMOTE] Button press: {button}") \
+    X(LOG_MOTOR_STATE_CHANGE,   "Motor state changed to {state} ({enabled}).") \
+    X(LOG_ENABLE_STATE_CHANGE,  "Play state changed to {enabled} (motor state: {state}).") \
+    X(LOG_NO_OP,                "(no-op)") \
+    X(LOG_BOOT_TIME,            "Motors ready {u32} us after reset.") \
+    X(LOG_BATTERY_LOW,          "Battery low: {d} mV.") \
+    X(LOG_STACK_UNUSED,         "Stack: {d} bytes never used.")
+
+#define SSBOT_LOG_ID(id, format) id,
+enum LogID : uint8_t {
+    SSBOT_LOG_MESSAGES(SSBOT_LOG_ID)
+    LOG_NUM_MESSAGES
+};
+#undef SSBOT_LOG_ID
+
+const uint8_t LOG_SYNC_BYTE = 0xA5;
+const uint8_t LOG_MAX_ARGS = 3;
+
+class Logger {
+    public:
+        Logger(Print& out);
+        void log(LogID id);
+        void log(LogID id, int16_t arg0);
+        void log(LogID id, int16_t arg0, int16_t arg1);
+        void log(LogID id, int16_t arg0, int16_t arg1, int16_t arg2);
+    private:
+        Print& _out;
+        void _send(LogID id, const int16_t* args, uint8_t argc);
+};
+
+} // end of SummerSpringBot namespace
+
+#endif
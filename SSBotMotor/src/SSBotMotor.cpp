@@ -8,14 +8,24 @@
 */
 
 #include <SSBotMotor.hpp>
+#include <SSBotFootprint.hpp>
 
 #define sgn(x) ((x) < 0 ? -1 : ((x) > 0 ? 1 : 0))
 
 using namespace SummerSpringBot;
 
-//================  MOTOR CONTROL =================
+#ifdef __AVR__
+static_assert(sizeof(Motor) <= MOTOR_SIZE_BUDGET, "Motor is over its RAM budget (SSBotFootprint.hpp)");
+static_assert(sizeof(DualMotors) <= DUAL_MOTORS_SIZE_BUDGET, "DualMotors is over its RAM budget (SSBotFootprint.hpp)");
+static_assert(sizeof(DifferentialDrive) <= DIFFERENTIAL_DRIVE_SIZE_BUDGET, "DifferentialDrive is over its RAM budget (SSBotFootprint.hpp)");
+#endif
 
+//================  MOTOR CONTROL =================
 
+// every Motor, so a new supply compensation reaches motors that are already running
+#define MAX_MOTORS 4
+static Motor* _allMotors[MAX_MOTORS];
+static uint8_t _numMotors = 0;
 
 Motor::Motor( uint8_t fwdPin, uint8_t revPin, uint8_t pwmPin, 
                     int maxPWM, int defaultSpeed) :
@@ -24,15 +34,51 @@ Motor::Motor( uint8_t fwdPin, uint8_t revPin, uint8_t pwmPin,
     _pwm = 0;
     _enabled = true;
     _state = STOPPED;
+    _resolution = 0;
+    if (_numMotors < MAX_MOTORS)
+        _allMotors[_numMotors++] = this;
 }
 
-void Motor::init() {
+Motor::~Motor() {
+    for (uint8_t i = 0; i < _numMotors; i++) {
+        if (_allMotors[i] == this) {
+            _allMotors[i] = _allMotors[--_numMotors];
+            break;
+        }
+    }
+}
+
+void Motor::init(bool loadStoredConfig) {
     pinMode(_pwmPin, OUTPUT);
     pinMode(_fwdPin, OUTPUT);
     pinMode(_revPin, OUTPUT);
+    RobotConfig config;
+    if (loadStoredConfig && loadRobotConfig(config)) {
+        setMaxPWM(config.leftMaxPWM);
+        setDefaultSpeed(config.defaultSpeed);
+    }
+    sendMotorControl();
+}
+
+void Motor::setMaxPWM(uint8_t maxPWM) {
+    _maxPWM = maxPWM;
+    if (_pwm > _maxDuty())
+        _pwm = _maxDuty();
     sendMotorControl();
 }
 
+void Motor::setDefaultSpeed(uint8_t speed) {
+    _defaultSpeed = speed;
+}
+
+uint8_t Motor::getMaxPWM() {
+    return _maxPWM;
+}
+
+uint8_t Motor::getDefaultSpeed() {
+    return _defaultSpeed;
+}
+
 void Motor::_setDir(int8_t dir){
     switch (dir) {
         case 1:
@@ -52,25 +98,98 @@ void Motor::_setDir(int8_t dir){
     }
 }
 
-void Motor::_setPWM(uint8_t pwm){
-    analogWrite(_pwmPin, pwm);
+void Motor::_setPWM(uint16_t pwm){
+    if (!_resolution) {
+        analogWrite(_pwmPin, pwm);
+        return;
+    }
+    // Timer1 owned by us: write the compare register directly. At 0 the output is
+    // disconnected and held low, since OCR=0 still leaves a 1-tick pulse each period.
+    uint8_t com = (_pwmPin == TIMER1_PWM_PIN_A) ? _BV(COM1A1) : _BV(COM1B1);
+    if (pwm == 0) {
+        TCCR1A &= ~com;
+        digitalWrite(_pwmPin, LOW);
+        return;
+    }
+    uint16_t duty = ((uint32_t)pwm * (ICR1 + 1UL)) >> _resolution;
+    if (_pwmPin == TIMER1_PWM_PIN_A) 
+        OCR1A = duty;
+    else 
+        OCR1B = duty;
+    TCCR1A |= com;
+}
+
+bool Motor::_useTimerPWM(uint8_t pwmPin, uint16_t top, uint8_t clockSelect, uint8_t resolution) {
+    if (pwmPin != _pwmPin)
+        return false;
+    _resolution = resolution;
+    _pwm = 0;
+
+    // fast PWM, TOP = ICR1 (mode 14); both Timer1 pins share this setup
+    pinMode(_pwmPin, OUTPUT);
+    TCCR1A = (TCCR1A & (_BV(COM1A1) | _BV(COM1B1))) | _BV(WGM11);
+    TCCR1B = _BV(WGM13) | _BV(WGM12) | clockSelect;
+    ICR1 = top;
+    sendMotorControl();
+    return true;
+}
+
+uint8_t Motor::getPWMPin() {
+    return _pwmPin;
 }
 
-uint8_t Motor::_speedToPWM(uint8_t speed) {
+// keep _maxPWM's meaning (fraction of full speed, out of 255) at any resolution: 
+// widen it by repeating its top bits, so 255 still means full scale (cheaper than 
+// caching the result -- no division, and 2 bytes less per motor)
+uint16_t Motor::_maxDuty() {
+    if (!_resolution)
+        return _maxPWM;
+    uint8_t extra = _resolution - 8;
+    return ((uint16_t)_maxPWM << extra) | (_maxPWM >> (8 - extra));
+}
+
+uint16_t Motor::_fullScalePWM() {
+    return _resolution ? (1U << _resolution) - 1 : 255;
+}
+
+uint16_t Motor::_speedToPWM(uint8_t speed) {
     if (speed == NO_ARG_FLAG) {
         if (_pwm == 0) 
-            return map(_defaultSpeed, 0, 100, 0, _maxPWM);
+            speed = _defaultSpeed;
         else 
             return _pwm;
-    } else {
-        return map(speed, 0, 100, 0, _maxPWM);
     }
+    return map(speed, 0, 100, 0, _maxDuty());
+}
+
+// _pwm is what was asked for; the pin gets it scaled up to make up for the battery
+uint16_t Motor::_compensatedPWM() {
+    if (_supplyCompensation == 256)
+        return _pwm;
+    uint32_t compensated = ((uint32_t)_pwm * _supplyCompensation) >> 8;
+    uint16_t maxDuty = _maxDuty();
+    return (compensated > maxDuty) ? maxDuty : compensated;
+}
+
+uint16_t Motor::_supplyCompensation = 256;
+
+void Motor::setSupplyCompensation(uint16_t factor) {
+    if (factor == _supplyCompensation)
+        return;
+    _supplyCompensation = factor;
+    // a motor cruising on an old command must speed up too, not just new commands
+    for (uint8_t i = 0; i < _numMotors; i++)
+        _allMotors[i]->sendMotorControl();
+}
+
+uint16_t Motor::getSupplyCompensation() {
+    return _supplyCompensation;
 }
 
 void Motor::sendMotorControl(){
     if(_enabled){
         _setDir(_state);
-        _setPWM(_pwm);
+        _setPWM(_compensatedPWM());
     } else {
         _setPWM(0);
         _setDir(0);
@@ -90,7 +209,7 @@ String Motor::getStateString() {
 }
 
 uint8_t Motor::getSpeed() {
-    return map(_pwm, 0, 255, 0, 100);
+    return map(_pwm, 0, _fullScalePWM(), 0, 100);
 }
 
 int8_t Motor::getVelocity() {
@@ -168,7 +287,6 @@ void Motor::drive(int8_t speed){
     // if (speed > 100 || speed < -100)
     //     throw std::invalid_argument("Motor.drive() only accepts values between -100 and 100.");
 
-    _pwm = map(abs(speed), 0, 100, 0, _maxPWM);
     sendMotorControl();
 }
 
@@ -187,8 +305,24 @@ DualMotors::DualMotors(
 { }
 
 void DualMotors::init() {
-    _motor0.init();
-    _motor1.init();
+    _motor0.init(false);
+    _motor1.init(false);
+    RobotConfig config;
+    if (loadRobotConfig(config))
+        applyConfig(config);
+}
+
+void DualMotors::applyConfig(const RobotConfig& config) {
+    _motor0.setMaxPWM(config.leftMaxPWM);
+    _motor1.setMaxPWM(config.rightMaxPWM);
+    _motor0.setDefaultSpeed(config.defaultSpeed);
+    _motor1.setDefaultSpeed(config.defaultSpeed);
+}
+
+void DualMotors::getConfig(RobotConfig& config) {
+    config.leftMaxPWM = _motor0.getMaxPWM();
+    config.rightMaxPWM = _motor1.getMaxPWM();
+    config.defaultSpeed = _motor0.getDefaultSpeed();
 }
 
 void DualMotors::enable(MotorID motorID) {
@@ -322,31 +456,49 @@ DifferentialDrive::DifferentialDrive(
     _rightWheel(rightFwdPin, rightRevPin, rightPwmPin, rightMaxPWM, defaultSpeed),
     _defaultSpeed(defaultSpeed)
 {
-    _enabled = true;
     _state = STOPPED;
-    _speed = 0;
+    _linear = 0;
+    _angular = 0;
+    _commandCount = 0;
 };
 
 void DifferentialDrive::init(){
-    _leftWheel.init();
-    _rightWheel.init();
+    _leftWheel.init(false);
+    _rightWheel.init(false);
+    RobotConfig config;
+    if (loadRobotConfig(config))
+        applyConfig(config);
+}
+
+void DifferentialDrive::applyConfig(const RobotConfig& config) {
+    _defaultSpeed = config.defaultSpeed;
+    _leftWheel.setMaxPWM(config.leftMaxPWM);
+    _rightWheel.setMaxPWM(config.rightMaxPWM);
+    _leftWheel.setDefaultSpeed(config.defaultSpeed);
+    _rightWheel.setDefaultSpeed(config.defaultSpeed);
+}
+
+void DifferentialDrive::getConfig(RobotConfig& config) {
+    config.leftMaxPWM = _leftWheel.getMaxPWM();
+    config.rightMaxPWM = _rightWheel.getMaxPWM();
+    config.defaultSpeed = _defaultSpeed;
 }
 
 void DifferentialDrive::enable() {
-    _enabled = true;
     _leftWheel.enable();
     _rightWheel.enable();
 }
 
 void DifferentialDrive::disable() {
-    _enabled = false;
     _leftWheel.disable();
     _rightWheel.disable();
 }
 
 void DifferentialDrive::stop() {
+    _commandCount++;
     _state = STOPPED;
-    _speed = 0;
+    _linear = 0;
+    _angular = 0;
     _leftWheel.stop();
     _rightWheel.stop();
 }
@@ -354,19 +506,39 @@ void DifferentialDrive::stop() {
 void DifferentialDrive::setSpeed(uint8_t speed) {
     if (_state == STOPPED) 
         _state = FWD;
-    _speed = _speedArgHandler(speed);
-    _leftWheel.setSpeed(_speed);
-    _rightWheel.setSpeed(_speed);
+    speed = _speedArgHandler(speed);
+    MotorState state = _state;
+    switch (state) {
+        case REV:
+            drive(-speed, 0);
+            break;
+        case TURN_LEFT:
+            drive(0, speed);
+            break;
+        case TURN_RIGHT:
+            drive(0, -speed);
+            break;
+        case ARC_LEFT:
+        case ARC_RIGHT:
+            // same curve, new speed: scale both wheels by speed/|linear|. With a 
+            // small linear that can ask for far more than 100; _setWheels() scales back.
+            if (_linear != 0)
+                _setWheels(((int32_t)_linear - _angular) * speed / abs(_linear),
+                           ((int32_t)_linear + _angular) * speed / abs(_linear));
+            else
+                drive(speed, (state == ARC_LEFT) ? speed : -speed);
+            break;
+        default:
+            drive(speed, 0);
+    }
+    // keep the direction even at speed 0, so a later setSpeed() carries on the same way
+    _state = state;
 }
 
 
 void DifferentialDrive::drive(int8_t speed) {
-    _speed = _speedArgHandler(abs(speed));
-    _state = (MotorState) sgn(speed);
-    speed = _state * _speed;
-
-    _leftWheel.drive(speed);
-    _rightWheel.drive(speed);
+    uint8_t magnitude = _speedArgHandler(abs(speed));
+    drive(sgn(speed) * magnitude, 0);
 }
 
 void DifferentialDrive::fwd(uint8_t speed) {
@@ -378,40 +550,76 @@ void DifferentialDrive::rev(uint8_t speed) {
 }
 
 void DifferentialDrive::turnLeft(uint8_t speed) {
-    _speed = _speedArgHandler(speed);
-    _state = TURN_LEFT;
-
-    _leftWheel.drive(-_speed);
-    _rightWheel.drive(_speed);
+    drive(0, _speedArgHandler(speed));
 }
 
 void DifferentialDrive::turnRight(uint8_t speed) {
-    _speed = _speedArgHandler(speed);
-    _state = TURN_RIGHT;
+    drive(0, -_speedArgHandler(speed));
+}
 
-    _leftWheel.drive(_speed);
-    _rightWheel.drive(-_speed);
+void DifferentialDrive::driveWheels(int8_t left, int8_t right) {
+    _setWheels(left, right);
+}
+
+void DifferentialDrive::drive(int8_t linear, int8_t angular) {
+    _setWheels((int16_t)linear - angular, (int16_t)linear + angular);
+}
+
+void DifferentialDrive::curvatureDrive(int8_t speed, int8_t curvature) {
+    // positive curvature turns right (CW), which is negative angular velocity
+    drive(speed, -(int16_t)speed * curvature / 100);
+}
+
+void DifferentialDrive::_setWheels(int32_t left, int32_t right) {
+    // saturate without bending the path: scale both wheels by the same ratio 
+    // (in 32 bits -- left * 100 overflows an AVR int from 328 up)
+    int32_t biggest = max(labs(left), labs(right));
+    if (biggest > 100) {
+        left = left * 100 / biggest;
+        right = right * 100 / biggest;
+    }
+
+    _leftWheel.drive(left);
+    _rightWheel.drive(right);
+    _commandCount++;
+
+    // classify from the wheels themselves, before halving can round a small 
+    // difference (or a small speed) away
+    if (left == right)
+        _state = (MotorState) sgn(left);
+    else if (left == -right)
+        _state = (right > 0) ? TURN_LEFT : TURN_RIGHT;
+    else
+        _state = (right > left) ? ARC_LEFT : ARC_RIGHT;
+    // halve rounding away from zero, so a moving robot never reports 0
+    _linear = _halfAwayFromZero(left + right);
+    _angular = _halfAwayFromZero(right - left);
+}
+
+int8_t DifferentialDrive::_halfAwayFromZero(int16_t twice) {
+    return (twice + sgn(twice)) / 2;
 }
 
 
 
 int8_t DifferentialDrive::getVelocity()
 {
-    int8_t velocity;
     switch (_state) {
-        case REV:
-        case STOPPED:
-        case FWD:
-            velocity = _state * _speed;
-            break;
         case TURN_LEFT: // CCW rotation is positive
-            velocity = _speed;
-            break;
         case TURN_RIGHT: // CW rotation is negative
-            velocity = -_speed;
-            break;
+            return _angular;
+        default:
+            return _linear;
     }
-    return velocity;
+}
+
+int8_t DifferentialDrive::getAngularVelocity()
+{
+    return _angular;
+}
+
+uint8_t DifferentialDrive::commandCount() {
+    return _commandCount;
 }
 
 DifferentialDrive::MotorState DifferentialDrive::getState() {
@@ -422,8 +630,8 @@ String DifferentialDrive::getStateString() {
     return stateToString(_state);
 }
 
- bool DifferentialDrive::isEnabled() {
-    return _enabled;
+bool DifferentialDrive::isEnabled() {
+    return _leftWheel.isEnabled(); // wheels are always enabled/disabled together
 }
 
 String DifferentialDrive::stateToString(bool enabled) {
@@ -450,15 +658,21 @@ String DifferentialDrive::stateToString(MotorState state) {
         case TURN_RIGHT:
             return "TURN_RIGHT";
             break;
+        case ARC_LEFT:
+            return "ARC_LEFT";
+            break;
+        case ARC_RIGHT:
+            return "ARC_RIGHT";
+            break;
         }
 }
 
 uint8_t DifferentialDrive::_speedArgHandler(uint8_t speed) {
     if (speed == NO_ARG_FLAG) {
-        if (_speed == 0) 
+        if (_currentSpeed() == 0) 
             speed = _defaultSpeed;
         else {
-            speed = _speed;
+            speed = _currentSpeed();
         }
     }
     
@@ -467,3 +681,7 @@ uint8_t DifferentialDrive::_speedArgHandler(uint8_t speed) {
 
     return speed;
 }
+
+uint8_t DifferentialDrive::_currentSpeed() {
+    return abs(getVelocity());
+}
@@ -1,4 +1,8 @@
+#ifndef SSBOT_MOTOR_H
+#define SSBOT_MOTOR_H
+
 #include <Arduino.h>
+#include <SSBotConfig.hpp>
 
 namespace SummerSpringBot {
 
@@ -6,14 +10,55 @@ namespace SummerSpringBot {
 // #define NO_ARG_FLAG 101
 const int NO_ARG_FLAG = 101;
 
+// Hardware PWM: Timer1 can drive its two PWM pins at a chosen frequency (e.g. 20 kHz
+// to stop motor whine) and 8-10 bit resolution, instead of analogWrite's ~490 Hz / 8-bit.
+// Once a motor owns Timer1, do NOT analogWrite() the other Timer1 pin yourself.
+#if defined(__AVR_ATmega2560__) || defined(__AVR_ATmega1280__)
+const uint8_t TIMER1_PWM_PIN_A = 11;
+const uint8_t TIMER1_PWM_PIN_B = 12;
+#else
+const uint8_t TIMER1_PWM_PIN_A = 9;
+const uint8_t TIMER1_PWM_PIN_B = 10;
+#endif
+const uint8_t MIN_PWM_RESOLUTION = 8;
+const uint8_t MAX_PWM_RESOLUTION = 10;
+
+constexpr bool isTimer1PWMPin(uint8_t pin) {
+    return (pin == TIMER1_PWM_PIN_A) || (pin == TIMER1_PWM_PIN_B);
+}
+// smallest Timer1 prescaler that fits a 16-bit TOP: 1, 8, 64, 256 or 1024
+constexpr unsigned long timer1Prescaler(unsigned long frequency) {
+    return (F_CPU / frequency <= 65536UL)        ? 1 :
+           (F_CPU / (8UL * frequency) <= 65536UL)  ? 8 :
+           (F_CPU / (64UL * frequency) <= 65536UL) ? 64 :
+           (F_CPU / (256UL * frequency) <= 65536UL) ? 256 : 1024;
+}
+// Timer1 clock select bits (CS12:0) for the prescaler above
+constexpr uint8_t timer1ClockSelect(unsigned long frequency) {
+    return (timer1Prescaler(frequency) == 1)   ? 1 :
+           (timer1Prescaler(frequency) == 8)   ? 2 :
+           (timer1Prescaler(frequency) == 64)  ? 3 :
+           (timer1Prescaler(frequency) == 256) ? 4 : 5;
+}
+// ICR1 value giving the requested frequency in fast PWM mode
+constexpr uint16_t timer1Top(unsigned long frequency) {
+    return F_CPU / (timer1Prescaler(frequency) * frequency) - 1;
+}
+
 // Class for SINGLE motor control
 class Motor {
     
     public:
-        enum MotorState {REV=-1, STOPPED, FWD};
+        enum MotorState : int8_t {REV=-1, STOPPED, FWD};
         Motor( uint8_t fwdPin, uint8_t revPin, uint8_t pwmPin,  
                     int maxPWM=255, int defaultSpeed=50);
-        void init();        
+        ~Motor();
+        // loads maxPWM (leftMaxPWM) and defaultSpeed from EEPROM if a config is stored there
+        void init(bool loadStoredConfig=true);
+        void setMaxPWM(uint8_t maxPWM);
+        void setDefaultSpeed(uint8_t speed);
+        uint8_t getMaxPWM();
+        uint8_t getDefaultSpeed();
         void enable();
         void disable();
         void fwd();
@@ -25,20 +70,51 @@ class Motor {
         bool isEnabled();
         int8_t getState();
         String getStateString();
+        // the speed asked for -- before any supply compensation
         uint8_t getSpeed();
         int8_t getVelocity();
         static String stateToString(bool enabled);
         static String stateToString(MotorState state);
 
+        // Scales every speed command to make up for a sagging battery, as a fraction 
+        // out of 256 (256 = no change, 320 = 25% more PWM). Shared by all motors and 
+        // applied to running motors straight away (up to 4 motors); normally set by 
+        // Battery. PWM never goes past maxPWM.
+        static void setSupplyCompensation(uint16_t factor);
+        static uint16_t getSupplyCompensation();
+
+        // take over Timer1 for this motor's PWM pin, e.g. useTimerPWM<10, 20000>().
+        // Returns false, and changes nothing, if pwmPin isn't the pin this motor was 
+        // constructed with.
+        template <uint8_t pwmPin, unsigned long frequency, uint8_t resolution = 8>
+        bool useTimerPWM() {
+            static_assert(isTimer1PWMPin(pwmPin), 
+                "useTimerPWM() only works on the two Timer1 PWM pins (9 and 10 on an Uno).");
+            static_assert(resolution >= MIN_PWM_RESOLUTION && resolution <= MAX_PWM_RESOLUTION,
+                "PWM resolution must be 8, 9 or 10 bits.");
+            static_assert(frequency >= 1 && frequency <= F_CPU / 256,
+                "PWM frequency out of range.");
+            static_assert(timer1Top(frequency) + 1UL >= (1UL << resolution),
+                "PWM frequency too high for this resolution (10-bit tops out around F_CPU/1024).");
+            return _useTimerPWM(pwmPin, timer1Top(frequency), timer1ClockSelect(frequency), resolution);
+        }
+        uint8_t getPWMPin();
+
     private:
         const uint8_t _pwmPin, _fwdPin, _revPin;
-        const uint8_t _maxPWM, _defaultSpeed;
-        bool _enabled;
+        uint8_t _maxPWM, _defaultSpeed;
         MotorState _state;
-        uint8_t _pwm;
+        uint8_t _enabled : 1;
+        uint8_t _resolution : 4;  // 0 = plain analogWrite, otherwise bits of Timer1 PWM
+        uint16_t _pwm;
+        static uint16_t _supplyCompensation;
         void _setDir(int8_t dir);
-        void _setPWM(uint8_t pwm);
-        uint8_t _speedToPWM(uint8_t speed);
+        void _setPWM(uint16_t pwm);
+        uint16_t _speedToPWM(uint8_t speed);
+        uint16_t _compensatedPWM();
+        uint16_t _fullScalePWM();
+        bool _useTimerPWM(uint8_t pwmPin, uint16_t top, uint8_t clockSelect, uint8_t resolution);
+        uint16_t _maxDuty();
 
 };
 
@@ -51,6 +127,9 @@ class DualMotors {
                                    uint8_t fwdPin1, uint8_t revPin1, uint8_t pwmPin1, 
                                    uint8_t maxPWM0 = 255, uint8_t maxPWM1 = 100, uint8_t defaultSpeed = 50);
         void init();
+        void applyConfig(const RobotConfig& config);
+        // copy the settings in use now (maxPWM, defaultSpeed) into config
+        void getConfig(RobotConfig& config);
         // control motors individually -- motor=0 for left motor, motor=1 for right motor
         void enable(MotorID id);
         void disable(MotorID id);
@@ -73,12 +152,14 @@ class DualMotors {
 // Class for controlling two motors TOGETHER as differential drive
 class DifferentialDrive {
     public:
-        enum MotorState {
+        enum MotorState : int8_t {
             REV = -1,
             STOPPED,   // =  0,
             FWD,       // =  1,
             TURN_LEFT, // =  2,
-            TURN_RIGHT // =  3,
+            TURN_RIGHT,// =  3,
+            ARC_LEFT,  // =  4, moving while turning CCW
+            ARC_RIGHT  // =  5, moving while turning CW
         };
         enum MotorID {
             LEFT = 0,
@@ -90,6 +171,10 @@ class DifferentialDrive {
                                 uint8_t rightFwdPin, uint8_t rightRevPin, uint8_t rightPwmPin,
                                 uint8_t leftMaxPWM = 255, uint8_t rightMaxPWM = 255, uint8_t defaultSpeed = 50);
         void init();
+        // change maxPWM/defaultSpeed on the fly (e.g. after saveRobotConfig())
+        void applyConfig(const RobotConfig& config);
+        // copy the settings in use now (maxPWM, defaultSpeed) into config
+        void getConfig(RobotConfig& config);
 
         /////// CONTROL ///////
         // suspend movement
@@ -104,24 +189,59 @@ class DifferentialDrive {
         void rev(uint8_t speed = NO_ARG_FLAG);
         void turnLeft(uint8_t speed = NO_ARG_FLAG);
         void turnRight(uint8_t speed = NO_ARG_FLAG);
+        // set each wheel's velocity (-100 to 100) directly, e.g. to steer along a line
+        void driveWheels(int8_t left, int8_t right);
+        // drive and turn at the same time (arcade style): linear is forward speed, angular 
+        // is turning speed (CCW/left positive), both -100 to 100. If a wheel would need 
+        // more than 100, both are scaled down together so the curve stays the same.
+        void drive(int8_t linear, int8_t angular);
+        // drive along a curve: curvature -100 (tightest left)... 0 (straight)... 100 (tightest right)
+        // -- unlike drive(linear, angular), the turning rate grows with speed
+        void curvatureDrive(int8_t speed, int8_t curvature);
 
         ///////  MONITOR  ///////
         // get current movement speed and direction as a signed integer
+        // (for TURN_LEFT/TURN_RIGHT, the turning speed, CCW positive)
         int8_t getVelocity();
+        // turning speed, CCW positive
+        int8_t getAngularVelocity();
         MotorState getState();
         String getStateString();
         bool isEnabled();
+        // goes up by one with every movement command (stop() included, wraps at 255), 
+        // so code that drives the robot itself can tell the user's commands from its own
+        uint8_t commandCount();
         static String stateToString(MotorState state);
         static String stateToString(bool enabled);
 
+        // run both wheels from Timer1 at a chosen PWM frequency and resolution, 
+        // e.g. useTimerPWM<leftMotorPWMPin, rightMotorPWMPin, 20000>(). The pins must be
+        // in the same order as in the constructor (left, then right); if they don't 
+        // match, it returns false and both wheels stay on analogWrite().
+        template <uint8_t leftPwmPin, uint8_t rightPwmPin, unsigned long frequency, uint8_t resolution = 8>
+        bool useTimerPWM() {
+            static_assert(leftPwmPin != rightPwmPin, "Left and right motors can't share a PWM pin.");
+            if (_leftWheel.getPWMPin() != leftPwmPin || _rightWheel.getPWMPin() != rightPwmPin)
+                return false;
+            return _leftWheel.useTimerPWM<leftPwmPin, frequency, resolution>()
+                && _rightWheel.useTimerPWM<rightPwmPin, frequency, resolution>();
+        }
+
     private:
-        const uint8_t _defaultSpeed;
+        uint8_t _defaultSpeed;
         Motor _leftWheel, _rightWheel;
-        bool _enabled;
+        // kept rather than worked out from the wheels: the wheels only hold PWM, which 
+        // doesn't map back to the exact speeds asked for, and setSpeed() needs the 
+        // direction even while stopped at speed 0
         MotorState _state;
-        uint8_t _speed;
+        int8_t _linear, _angular;
+        uint8_t _commandCount;
         uint8_t _speedArgHandler(uint8_t speedArg);
+        uint8_t _currentSpeed();
+        void _setWheels(int32_t left, int32_t right);
+        static int8_t _halfAwayFromZero(int16_t twice);
 };
 
 } // end of SummerSpringBot namespace
 
+#endif
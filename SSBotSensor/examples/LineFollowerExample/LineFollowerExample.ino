@@ -0,0 +1,63 @@
+#include <SSBotMotor.hpp>
+#include <SSBotLine.hpp>
+
+using namespace SummerSpringBot;
+
+
+///////////////////////////////////////////////////////////////////////
+// *********************  HARDWARE INTERFACE  ********************* ///
+///////////////////////////////////////////////////////////////////////
+
+/// --------------------- MOTOR CONTROLLER  --------------------- ///
+
+const uint8_t leftMotorPWMPin = 10;
+const uint8_t leftMotorFwdPin = 11;
+const uint8_t leftMotorRevPin = 12;
+
+const uint8_t rightMotorPWMPin = 9;
+const uint8_t rightMotorFwdPin = 7;
+const uint8_t rightMotorRevPin = 8;
+
+const uint8_t leftMotorMaxPWM  = 255;
+const uint8_t rightMotorMaxPWM = 255;
+
+DifferentialDrive motors(
+    leftMotorFwdPin,  leftMotorRevPin,  leftMotorPWMPin, 
+    rightMotorFwdPin, rightMotorRevPin, rightMotorPWMPin, 
+    leftMotorMaxPWM,  rightMotorMaxPWM);
+
+
+/// --------------------- LINE SENSOR CONFIGURATION --------------------- ///
+
+// analog reflectance sensors, listed left to right
+const uint8_t lineSensorPins[] = {A0, A1, A2, A3, A4};
+LineSensorArray lineSensors(lineSensorPins, 5, LineSensorArray::ANALOG);
+
+// for digital on/off sensor modules, put them all on pins 2-7 (same port) instead:
+// const uint8_t lineSensorPins[] = {3, 4, 5, 6};
+// LineSensorArray lineSensors(lineSensorPins, 4, LineSensorArray::DIGITAL);
+
+const uint8_t followSpeed = 50; // %
+const uint8_t steeringGain = 60; // % wheel difference when the line is at the edge
+
+
+///////////////////////////////////////////////////////////////////////
+// *************************    MAIN    *************************** ///
+///////////////////////////////////////////////////////////////////////
+
+void setup() {
+  motors.init();
+  lineSensors.init();
+
+  // calibrate: spin in place over the line for 3 seconds
+  motors.turnLeft(30);
+  unsigned long start = millis();
+  while (millis() - start < 3000) 
+    lineSensors.calibrate();
+  motors.stop();
+}
+
+void loop() {
+  // reading the sensors never waits on the ADC, so this loop runs very fast
+  lineSensors.steer(motors, followSpeed, steeringGain);
+}
@@ -0,0 +1,70 @@
+#include <SSBotMotor.hpp>
+#include <SSBotSensor.hpp>
+#include <SSBotScript.hpp>
+
+using namespace SummerSpringBot;
+
+
+///////////////////////////////////////////////////////////////////////
+// *********************  HARDWARE INTERFACE  ********************* ///
+///////////////////////////////////////////////////////////////////////
+
+/// --------------------- MOTOR CONTROLLER  --------------------- ///
+
+const uint8_t leftMotorPWMPin = 10;
+const uint8_t leftMotorFwdPin = 11;
+const uint8_t leftMotorRevPin = 12;
+
+const uint8_t rightMotorPWMPin = 9;
+const uint8_t rightMotorFwdPin = 7;
+const uint8_t rightMotorRevPin = 8;
+
+const uint8_t leftMotorMaxPWM  = 255;
+const uint8_t rightMotorMaxPWM = 255;
+
+DifferentialDrive motors(
+    leftMotorFwdPin,  leftMotorRevPin,  leftMotorPWMPin, 
+    rightMotorFwdPin, rightMotorRevPin, rightMotorPWMPin, 
+    leftMotorMaxPWM,  rightMotorMaxPWM);
+
+
+/// --------------------- SONAR CONFIGURATION --------------------- ///
+
+#define SONAR_TRIG_PIN 3
+#define SONAR_ECHO_PIN 4
+Sonar sonar(SONAR_TRIG_PIN, SONAR_ECHO_PIN);
+
+
+///////////////////////////////////////////////////////////////////////
+// *********************  MOTION SCRIPT  ************************** ///
+///////////////////////////////////////////////////////////////////////
+
+// Drive a square 4 times, then drive forward until something is closer than 20 cm.
+// The script lives in flash (PROGMEM) so it doesn't use any RAM.
+const MotionStep squareThenApproach[] PROGMEM = {
+  /* 0 */ MOTION_DRIVE(60, 1500),       // forward at 60% for 1.5 s
+  /* 1 */ MOTION_TURN_LEFT(50, 400),    // quarter turn
+  /* 2 */ MOTION_LOOP(0, 4),            // back to step 0, 4 times in total
+  /* 3 */ MOTION_DRIVE(40, 0),          // start driving forward...
+  /* 4 */ MOTION_WAIT_SONAR(20),        // ...until an obstacle is within 20 cm
+  /* 5 */ MOTION_STOP(0),
+  /* 6 */ MOTION_END()
+};
+
+MotionScript script(motors, sonar);
+
+
+///////////////////////////////////////////////////////////////////////
+// *************************    MAIN    *************************** ///
+///////////////////////////////////////////////////////////////////////
+
+void setup() {
+  motors.init();
+  sonar.init();
+  script.run(squareThenApproach);
+}
+
+void loop() {
+  // runs one step at a time without delay(), so there is time left over for sensors
+  script.tick();
+}
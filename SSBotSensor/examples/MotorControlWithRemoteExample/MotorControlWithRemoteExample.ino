@@ -1,6 +1,6 @@
 #include <SSBotMotor.hpp>
 #include <SSBotSensor.hpp>
-#include <string.h>
+#include <SSBotLog.hpp>
 
 using namespace SummerSpringBot;
 
@@ -23,12 +23,16 @@ using namespace SummerSpringBot;
 createSafeStringReader(serialRx, SSBOTSERIAL_RX_BUFFER_LEN, SSBOTSERIAL_RX_DELIM);
 createBufferedOutput(serialTx, SSBOTSERIAL_TX_BUFFER_LEN, DROP_UNTIL_EMPTY);
 
+// log messages go out as compact binary frames; read them with tools/ssbot_log.py
+Logger logger(serialTx);
+
+// doesn't wait for the Serial Monitor: output is buffered and sent in the background by 
+// serialTx.nextByteOut(), so motors and sensors can start right away
 void serialInit(){
   Serial.begin(BAUD_RATE);
-  delay(2000);
   serialRx.connect(Serial);
   serialTx.connect(Serial);
-  serialTx.println(F("Serial communication ready."));
+  logger.log(LOG_SERIAL_READY);
 }
 
 
@@ -64,9 +68,12 @@ IRSensor remote(irSensorPin);
 /// --------------------- SETUP --------------------- ///
 
 void setup() {
-  serialInit();
-  remote.init();
+  // bring up the hardware first so the robot responds immediately
   motors.init();
+  unsigned long motorsReadyMicros = micros();
+  remote.init();
+  serialInit();
+  logger.log(LOG_BOOT_TIME, motorsReadyMicros, motorsReadyMicros >> 16); // sent as two 16-bit halves
 }
 
 
@@ -84,14 +91,16 @@ void loop() {
     // otherwise, continue execution
 }
 
-void printRemoteCommand(IRCommand command, bool newline=false);
-void printEnableStateChange(bool newline=false);
-void printMotorStateChange(bool newline=false);
+void printRemoteCommand(IRCommand command);
+void printEnableStateChange();
+void printMotorStateChange();
 
 // respond to user controls sent from IR Remote buttons
 void remoteControl(IRCommand command){
-  printRemoteCommand(command, false);
-  if (command == CMD_PLAY)  {
+  printRemoteCommand(command);
+  // PLAY = pause, CH = stop, CH+ / CH- = forward / reverse, << / >> = turn left / right,
+  // unless a different keymap was saved to EEPROM
+  if (command == remote.key(KEY_ENABLE))  {
     if (motors.isEnabled()) {
         motors.disable();
     } 
@@ -101,100 +110,38 @@ void remoteControl(IRCommand command){
     printEnableStateChange();
   } 
   else {
-    bool motorStateChange = false;
-    switch (command) {
-      // CH = STOPPED
-      case CMD_CH:
-        motors.stop();
-        motorStateChange = true;
-        break;
-      // CH+ = FWD
-      case CMD_CHUP:
-        motors.fwd();
-        motorStateChange = true;
-        break;
-      // CH- = REV
-      case CMD_CHDOWN:
-        motors.rev();
-        motorStateChange = true;
-        break;
-      // << = TURN_LEFT
-      case CMD_PREV:
-        motors.turnLeft();
-        motorStateChange = true;
-        break;
-      // << = TURN_RIGHT
-      case CMD_NEXT:
-        motors.turnRight();
-        motorStateChange = true;
-        break;
-      // any of the other commands  
-      default:
-        ;
-        // no-op
-    } // end of switch(command)
+    bool motorStateChange = true;
+    if (command == remote.key(KEY_STOP))
+      motors.stop();
+    else if (command == remote.key(KEY_FWD))
+      motors.fwd();
+    else if (command == remote.key(KEY_REV))
+      motors.rev();
+    else if (command == remote.key(KEY_LEFT))
+      motors.turnLeft();
+    else if (command == remote.key(KEY_RIGHT))
+      motors.turnRight();
+    else // any of the other commands: no-op
+      motorStateChange = false;
 
     if (motorStateChange)
         printMotorStateChange();
     else 
-      serialTx.print("(no-op) ");
+      logger.log(LOG_NO_OP);
 
   } // end of else 
 
-  serialTx.println();
-
 } // end of remote control
 
 
-void printRemoteCommand(IRCommand command, bool newline=false){
-  serialTx.print(F("[REMOTE] Button press: "));
-  serialTx.print(padRight(IRSensor::str(command).c_str(), 4));
-  serialTx.print(F(" |  "));
-  if (newline) serialTx.println();
+void printRemoteCommand(IRCommand command){
+  logger.log(LOG_REMOTE_BUTTON, command);
 }
 
-
-void printMotorStateChange(bool newline=false){
-  serialTx.print(F("Motor state changed to "));
-  serialTx.print(motors.getStateString().c_str());
-  if (!motors.isEnabled())
-    serialTx.print(" (currently DISABLED)");
-  serialTx.print(F("."));
-  if (newline) serialTx.println();
+void printMotorStateChange(){
+  logger.log(LOG_MOTOR_STATE_CHANGE, motors.getState(), motors.isEnabled());
 }
 
-void printEnableStateChange(bool newline=false){
-  if (motors.isEnabled()){
-    serialTx.print(F("Play state changed to ENABLED. Resuming execution with motor state "));
-    serialTx.print(motors.getStateString().c_str());
-    serialTx.print(F(". "));
-  } else {
-    serialTx.print(F("Play state changed to DISABLED"));
-    serialTx.print(F(" (motor state: "));
-    serialTx.print(motors.getStateString().c_str());
-    serialTx.print(F("). "));
-  }
-  if (newline) serialTx.println();
-}
-
-
-
-char* padRight(char* str, size_t fixedWidth) { 
-  static char buffer[SSBOTSERIAL_TX_BUFFER_LEN]; 
-  size_t L = strlen(str);
-  char *b = buffer;
-  char *s = str;
-
-  // write chars from str into buffer from left to right
-  while ( (b-buffer < L) && (b-buffer < fixedWidth) && (b-buffer < SSBOTSERIAL_TX_BUFFER_LEN))
-    *b++ = *s++; // overwite value at b with value at s, then increment both b and s
-  
-  // then pad any remaining buffer with whitespace
-  while ((b < buffer + fixedWidth) && (b < buffer + SSBOTSERIAL_TX_BUFFER_LEN) ) 
-    *b++ = ' '; // overwrite at b, then increment
-
-  // b points to end of buffer; add null-termination
-  *b = '\0'; 
-  
-  return buffer;
+void printEnableStateChange(){
+  logger.log(LOG_ENABLE_STATE_CHANGE, motors.isEnabled(), motors.getState());
 }
@@ -4,6 +4,8 @@
 ///////////////////////////////////////////////////////////////////////
 
 // if two-player, uncomment your team. If single-player, comment out both.
+// (A keymap saved to EEPROM with saveRobotConfig() overrides the team chosen here;
+// call eraseRobotConfig() once to go back to these buttons.)
 
 /* Blue team control (top half of remote):
 
@@ -35,13 +37,24 @@
 // #define RED_TEAM 
 
 
+/* Own remote (any number of players):
+
+  If every player has a remote with its OWN address, comment out both teams above 
+  and uncomment this instead. After reset, the robot pairs with whichever remote 
+  presses a button first and ignores all the others, so everyone gets the full 
+  1-player keypad (CH+ / CH- / << / >> / CH / PLAY).
+
+*/
+// #define OWN_REMOTE
+
+
 ///////////////////////////////////////////////////////////////////////
 //// ***********************  CODE SETUP  ************************ ////
 ///////////////////////////////////////////////////////////////////////
 
 #include <SSBotMotor.hpp>
 #include <SSBotSensor.hpp>
-#include <string.h>
+#include <SSBotLog.hpp>
 
 using namespace SummerSpringBot;
 
@@ -63,12 +76,16 @@ using namespace SummerSpringBot;
 createSafeStringReader(serialRx, SSBOTSERIAL_RX_BUFFER_LEN, SSBOTSERIAL_RX_DELIM);
 createBufferedOutput(serialTx, SSBOTSERIAL_TX_BUFFER_LEN, DROP_UNTIL_EMPTY);
 
+// log messages go out as compact binary frames; read them with tools/ssbot_log.py
+Logger logger(serialTx);
+
+// doesn't wait for the Serial Monitor: output is buffered and sent in the background by 
+// serialTx.nextByteOut(), so motors and sensors can start right away
 void serialInit(){
   Serial.begin(BAUD_RATE);
-  delay(2000);
   serialRx.connect(Serial);
   serialTx.connect(Serial);
-  serialTx.println(F("Serial communication ready."));
+  logger.log(LOG_SERIAL_READY);
 }
 
 
@@ -104,9 +121,15 @@ IRSensor remote(irSensorPin);
 /// --------------------- SETUP --------------------- ///
 
 void setup() {
-  serialInit();
-  remote.init();
+  // bring up the hardware first so the robot responds immediately
   motors.init();
+  unsigned long motorsReadyMicros = micros();
+  remote.init();
+#ifdef OWN_REMOTE
+  remote.pair();
+#endif
+  serialInit();
+  logger.log(LOG_BOOT_TIME, motorsReadyMicros, motorsReadyMicros >> 16); // sent as two 16-bit halves
 }
 
 
@@ -129,14 +152,15 @@ void loop() {
 ///////////////////////////////////////////////////////////////////////////////////
 
 
-void printRemoteCommand(IRCommand command, bool newline=false);
-void printEnableStateChange(bool newline=false);
-void printMotorStateChange(bool newline=false);
+void printRemoteCommand(IRCommand command);
+void printEnableStateChange();
+void printMotorStateChange();
 
 // respond to user controls sent from IR Remote buttons
 void remoteControl(IRCommand command){
-  printRemoteCommand(command, false);
-  if (command == ENABLE_BUTTON)  {
+  printRemoteCommand(command);
+  // buttons come from the team keymap above, or from EEPROM if one was saved there
+  if (command == remote.key(KEY_ENABLE))  {
     if (motors.isEnabled()) {
         motors.disable();
     } 
@@ -146,95 +170,38 @@ void remoteControl(IRCommand command){
     printEnableStateChange();
   } 
   else {
-    bool motorStateChange = false;
-    switch (command) {
-      case STOP_BUTTON:
-        motors.stop();
-        motorStateChange = true;
-        break;
-      case FWD_BUTTON:
-        motors.fwd();
-        motorStateChange = true;
-        break;
-      case REV_BUTTON:
-        motors.rev();
-        motorStateChange = true;
-        break;
-      case LEFT_BUTTON:
-        motors.turnLeft();
-        motorStateChange = true;
-        break;
-      case RIGHT_BUTTON:
-        motors.turnRight();
-        motorStateChange = true;
-        break;
-      // any of the other commands  
-      default:
-        ;
-        // no-op
-    } // end of switch(command)
+    bool motorStateChange = true;
+    if (command == remote.key(KEY_STOP))
+      motors.stop();
+    else if (command == remote.key(KEY_FWD))
+      motors.fwd();
+    else if (command == remote.key(KEY_REV))
+      motors.rev();
+    else if (command == remote.key(KEY_LEFT))
+      motors.turnLeft();
+    else if (command == remote.key(KEY_RIGHT))
+      motors.turnRight();
+    else // any of the other commands: no-op
+      motorStateChange = false;
 
     if (motorStateChange)
         printMotorStateChange();
     else 
-      serialTx.print("(no-op) ");
+      logger.log(LOG_NO_OP);
 
   } // end of else 
 
-  serialTx.println();
-
 } // end of remote control
 
 
-void printRemoteCommand(IRCommand command, bool newline=false){
-  serialTx.print(F("[REMOTE] Button press: "));
-  serialTx.print(padRight(IRSensor::str(command).c_str(), 4));
-  serialTx.print(F(" |  "));
-  if (newline) serialTx.println();
+void printRemoteCommand(IRCommand command){
+  logger.log(LOG_REMOTE_BUTTON, command);
 }
 
-
-void printMotorStateChange(bool newline=false){
-  serialTx.print(F("Motor state changed to "));
-  serialTx.print(motors.getStateString().c_str());
-  if (!motors.isEnabled())
-    serialTx.print(" (currently DISABLED)");
-  serialTx.print(F("."));
-  if (newline) serialTx.println();
-}
-
-void printEnableStateChange(bool newline=false){
-  if (motors.isEnabled()){
-    serialTx.print(F("Play state changed to ENABLED. Resuming execution with motor state "));
-    serialTx.print(motors.getStateString().c_str());
-    serialTx.print(F(". "));
-  } else {
-    serialTx.print(F("Play state changed to DISABLED"));
-    serialTx.print(F(" (motor state: "));
-    serialTx.print(motors.getStateString().c_str());
-    serialTx.print(F("). "));
-  }
-  if (newline) serialTx.println();
+void printMotorStateChange(){
+  logger.log(LOG_MOTOR_STATE_CHANGE, motors.getState(), motors.isEnabled());
 }
 
-
-
-char* padRight(char* str, size_t fixedWidth) { 
-  static char buffer[SSBOTSERIAL_TX_BUFFER_LEN]; 
-  size_t L = strlen(str);
-  char *b = buffer;
-  char *s = str;
-
-  // write chars from str into buffer from left to right
-  while ( (b-buffer < L) && (b-buffer < fixedWidth) && (b-buffer < SSBOTSERIAL_TX_BUFFER_LEN))
-    *b++ = *s++; // overwite value at b with value at s, then increment both b and s
-  
-  // then pad any remaining buffer with whitespace
-  while ((b < buffer + fixedWidth) && (b < buffer + SSBOTSERIAL_TX_BUFFER_LEN) ) 
-    *b++ = ' '; // overwrite at b, then increment
-
-  // b points to end of buffer; add null-termination
-  *b = '\0'; 
-  
-  return buffer;
+void printEnableStateChange(){
+  logger.log(LOG_ENABLE_STATE_CHANGE, motors.isEnabled(), motors.getState());
 }
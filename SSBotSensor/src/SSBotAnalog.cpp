@@ -0,0 +1,101 @@
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include <SSBotAnalog.hpp>
+
+using namespace SummerSpringBot;
+
+// ADC clock = F_CPU/128 = 125kHz at 16MHz: full 10-bit accuracy, ~104us per conversion
+#define ADC_PRESCALER_BITS (_BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0))
+#define ADC_REFERENCE_BITS _BV(REFS0) // AVcc
+
+static uint8_t _channels[MAX_ANALOG_CHANNELS];
+static volatile uint16_t _values[MAX_ANALOG_CHANNELS];
+static uint8_t _numChannels = 0;
+static volatile uint8_t _current = 0;
+static volatile uint16_t _sweeps = 0;
+static volatile bool _swept = false; // every channel converted since start()
+static bool _running = false;
+
+static uint8_t _pinToChannel(uint8_t pin) {
+#ifdef analogPinToChannel
+  if (pin >= A0) pin -= A0;
+  return analogPinToChannel(pin);
+#else
+  return (pin >= A0) ? pin - A0 : pin;
+#endif
+}
+
+static inline void _selectChannel(uint8_t channel) {
+  ADMUX = ADC_REFERENCE_BITS | (channel & 0x0F);
+}
+
+//================  ANALOG SAMPLER =================
+
+int8_t AnalogSampler::addChannel(uint8_t pin) {
+  if (_numChannels >= MAX_ANALOG_CHANNELS)
+    return -1;
+  // pause the ISR while the channel list changes
+  bool wasRunning = _running;
+  stop();
+  _channels[_numChannels] = _pinToChannel(pin);
+  _values[_numChannels] = 0;
+  int8_t slot = _numChannels++;
+  if (wasRunning)
+    start();
+  return slot;
+}
+
+void AnalogSampler::start() {
+  if (_numChannels == 0)
+    return;
+  _current = 0;
+  _swept = false;
+  _selectChannel(_channels[0]);
+  ADCSRA = _BV(ADEN) | _BV(ADIE) | ADC_PRESCALER_BITS;
+  ADCSRA |= _BV(ADSC);
+  _running = true;
+}
+
+void AnalogSampler::stop() {
+  // let a conversion in progress finish, then turn the interrupt off
+  ADCSRA &= ~_BV(ADIE);
+  while (ADCSRA & _BV(ADSC));
+  _running = false;
+}
+
+bool AnalogSampler::isRunning() {
+  return _running;
+}
+
+uint16_t AnalogSampler::read(uint8_t slot) {
+  uint16_t value;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    value = _values[slot];
+  }
+  return value;
+}
+
+bool AnalogSampler::ready() {
+  return _swept;
+}
+
+uint16_t AnalogSampler::sweeps() {
+  uint16_t count;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    count = _sweeps;
+  }
+  return count;
+}
+
+ISR(ADC_vect) {
+  uint8_t i = _current;
+  _values[i] = ADC;
+  if (++i >= _numChannels) {
+    i = 0;
+    _sweeps++;
+    _swept = true;
+  }
+  _current = i;
+  _selectChannel(_channels[i]);
+  ADCSRA |= _BV(ADSC);
+}
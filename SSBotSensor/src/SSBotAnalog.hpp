@@ -0,0 +1,36 @@
+#ifndef SSBOT_ANALOG_H
+#define SSBOT_ANALOG_H
+
+#include <Arduino.h>
+
+namespace SummerSpringBot {
+
+
+// ------------------ BACKGROUND ADC ------------------
+
+#define MAX_ANALOG_CHANNELS 8
+
+// Samples analog pins in the background: each ADC conversion-complete interrupt 
+// stores the result and starts the next channel, so reading a value is just a copy
+// and nothing ever waits on analogRead() (~110us each). One ADC, so this is static.
+// Don't call analogRead() yourself while it is running.
+class AnalogSampler {
+  public:
+    // register a pin (A0, A1, ...); returns its slot, or -1 if all slots are taken
+    static int8_t addChannel(uint8_t pin);
+    static void start();
+    static void stop();
+    static bool isRunning();
+    // true once every channel has been converted since start(); until then some 
+    // slots still hold 0 rather than a reading
+    static bool ready();
+    // latest 10-bit value for a slot
+    static uint16_t read(uint8_t slot);
+    // how many full passes over all channels have completed (wraps around)
+    static uint16_t sweeps();
+};
+
+
+} // end of namespace SummerSpringBot
+
+#endif
@@ -0,0 +1,89 @@
+#include <SSBotBattery.hpp>
+#include <SSBotFootprint.hpp>
+
+using namespace SummerSpringBot;
+
+#ifdef __AVR__
+static_assert(sizeof(Battery) <= BATTERY_SIZE_BUDGET, "Battery is over its RAM budget (SSBotFootprint.hpp)");
+#endif
+
+#define BATTERY_FILTER_SHIFT 3         // low-pass: each new sample moves the estimate 1/8 of the way
+#define BATTERY_LOW_HYSTERESIS 100     // mV above lowMillivolts before "low" clears again
+#define MAX_SUPPLY_COMPENSATION 512    // never more than double the PWM
+
+//================  BATTERY =================
+
+Battery::Battery(uint8_t pin, uint16_t fullScaleMillivolts, uint16_t nominalMillivolts, uint16_t lowMillivolts) :
+  _pin(pin), _fullScaleMillivolts(fullScaleMillivolts), _nominalMillivolts(nominalMillivolts), 
+  _lowMillivolts(lowMillivolts) {
+  _slot = -1;
+  _compensate = true;
+  _low = false;
+  _lowEvent = false;
+  _lastSweep = 0;
+  _millivolts = 0;
+  _compensation = 256;
+}
+
+bool Battery::init() {
+  _slot = AnalogSampler::addChannel(_pin);
+  if (_slot < 0)
+    return false;
+  if (!AnalogSampler::isRunning())
+    AnalogSampler::start();
+  return true;
+}
+
+void Battery::update() {
+  if (_slot < 0)
+    return;
+  // only do work when the sampler has a new reading for us
+  uint16_t sweep = AnalogSampler::sweeps();
+  if (sweep == _lastSweep)
+    return;
+  _lastSweep = sweep;
+
+  uint16_t sample = ((uint32_t)AnalogSampler::read(_slot) * _fullScaleMillivolts) >> 10;
+  if (_millivolts == 0)
+    _millivolts = sample; // first reading: no history to filter against
+  else
+    _millivolts += ((int16_t)(sample - _millivolts)) >> BATTERY_FILTER_SHIFT;
+
+  if (!_low && _millivolts < _lowMillivolts) {
+    _low = true;
+    _lowEvent = true;
+  } else if (_low && _millivolts > _lowMillivolts + BATTERY_LOW_HYSTERESIS) {
+    _low = false;
+  }
+
+  // nominal / actual, out of 256
+  if (_millivolts > 0) {
+    uint32_t factor = ((uint32_t)_nominalMillivolts << 8) / _millivolts;
+    _compensation = (factor > MAX_SUPPLY_COMPENSATION) ? MAX_SUPPLY_COMPENSATION : factor;
+  }
+  if (_compensate)
+    Motor::setSupplyCompensation(_compensation);
+}
+
+uint16_t Battery::millivolts() {
+  return _millivolts;
+}
+
+uint16_t Battery::compensation() {
+  return _compensation;
+}
+
+void Battery::setCompensationEnabled(bool enabled) {
+  _compensate = enabled;
+  Motor::setSupplyCompensation(enabled ? _compensation : 256);
+}
+
+bool Battery::isLow() {
+  return _low;
+}
+
+bool Battery::lowVoltageEvent() {
+  bool event = _lowEvent;
+  _lowEvent = false;
+  return event;
+}
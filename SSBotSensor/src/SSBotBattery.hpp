@@ -0,0 +1,48 @@
+#ifndef SSBOT_BATTERY_H
+#define SSBOT_BATTERY_H
+
+#include <Arduino.h>
+#include <SSBotMotor.hpp>
+#include <SSBotAnalog.hpp>
+
+namespace SummerSpringBot {
+
+
+// ------------------ BATTERY MONITOR ------------------
+
+// Watches the battery voltage through a voltage divider on an analog pin. Sampling
+// happens in the background (AnalogSampler); update() only filters the latest 
+// sample, so it is cheap enough to call every loop(). While compensation is on, it 
+// tells Motor to scale up PWM as the battery drains, so drive(50) stays the same speed.
+class Battery {
+  public:
+    // fullScaleMillivolts: battery voltage that reads as 1023, i.e. 5000 mV times 
+    //                      the divider ratio (10000 for two equal resistors)
+    // nominalMillivolts:   voltage your speeds were tuned at (e.g. a fresh 4xAA = 6000)
+    // lowMillivolts:       below this, lowVoltageEvent() fires
+    Battery(uint8_t pin, uint16_t fullScaleMillivolts=10000, 
+            uint16_t nominalMillivolts=6000, uint16_t lowMillivolts=4800);
+    bool init();
+    void update();
+    uint16_t millivolts();
+    // motor PWM scale factor out of 256 (see Motor::setSupplyCompensation)
+    uint16_t compensation();
+    void setCompensationEnabled(bool enabled);
+    bool isLow();
+    // true once each time the voltage drops below lowMillivolts
+    bool lowVoltageEvent();
+
+  private:
+    const uint8_t _pin;
+    const uint16_t _fullScaleMillivolts, _nominalMillivolts, _lowMillivolts;
+    int8_t _slot;
+    bool _compensate, _low, _lowEvent;
+    uint16_t _lastSweep;
+    uint16_t _millivolts;
+    uint16_t _compensation;
+};
+
+
+} // end of namespace SummerSpringBot
+
+#endif
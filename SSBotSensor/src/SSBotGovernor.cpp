@@ -0,0 +1,137 @@
+#include <SSBotGovernor.hpp>
+#include <SSBotFootprint.hpp>
+
+using namespace SummerSpringBot;
+
+#ifdef __AVR__
+static_assert(sizeof(SpeedGovernor) <= SPEED_GOVERNOR_SIZE_BUDGET, "SpeedGovernor is over its RAM budget (SSBotFootprint.hpp)");
+#endif
+
+static uint16_t isqrt(uint32_t n) {
+  uint32_t root = 0, bit = 1UL << 30;
+  while (bit > n) 
+    bit >>= 2;
+  while (bit) {
+    if (n >= root + bit) {
+      n -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return root;
+}
+
+//================  SPEED GOVERNOR =================
+
+SpeedGovernor::SpeedGovernor(DifferentialDrive& drive, Sonar& sonar, 
+                             unsigned int topSpeed, unsigned int braking, unsigned int reaction) : 
+  _drive(drive), _sonar(sonar), _topSpeed(topSpeed), _braking(braking), _reaction(reaction) {
+  _lastReadTime = 0;
+  _lastDistance = 0;
+  _closingSpeed = 0;
+  _speedLimit = 100;
+  _requestedSpeed = 0;
+  _requestedAngular = 0;
+  _governedSpeed = 0;
+  _lastCommand = 0;
+}
+
+uint8_t SpeedGovernor::speedLimit() {
+  return _speedLimit;
+}
+
+int SpeedGovernor::closingSpeed() {
+  return _closingSpeed;
+}
+
+// moving forward, on a straight line or a curve (FWD/ARC_* are still set while we 
+// hold the robot at speed 0); turning on the spot or reversing can't run into what 
+// the sonar sees
+bool SpeedGovernor::_movingForward() {
+  DifferentialDrive::MotorState state = _drive.getState();
+  if (state != DifferentialDrive::FWD && state != DifferentialDrive::ARC_LEFT && 
+      state != DifferentialDrive::ARC_RIGHT)
+    return false;
+  return _drive.getVelocity() >= 0;
+}
+
+void SpeedGovernor::update() {
+  if (!_movingForward()) {
+    // nothing to govern; the next forward command is picked up through commandCount()
+    _requestedSpeed = 0;
+    _governedSpeed = 0;
+    _sonar.setLookahead(0);
+    return;
+  }
+  // any command since our own is the user asking for a new speed -- even if it is 
+  // the speed we were holding
+  uint8_t speed = _drive.getVelocity();
+  if (_drive.commandCount() != _lastCommand) {
+    _requestedSpeed = speed;
+    _requestedAngular = _drive.getAngularVelocity();
+  }
+
+  int distance = _sonar.read();
+  unsigned long readTime = _sonar.readTime();
+  if (readTime != _lastReadTime) {
+    // new reading: update closing speed (0 = nothing in range, so nothing to close on)
+    unsigned long dt = readTime - _lastReadTime;
+    if (distance > 0 && _lastDistance > 0 && dt > 0 && dt < 500) {
+      int measured = (long)(_lastDistance - distance) * 1000 / (long)dt;
+      _closingSpeed = (3 * _closingSpeed + measured) / 4; // low-pass, sonar is noisy
+    } else {
+      _closingSpeed = 0;
+    }
+    _lastDistance = distance;
+    _lastReadTime = readTime;
+    _speedLimit = _limitForDistance(distance);
+  }
+
+  uint8_t target = min(_requestedSpeed, _speedLimit);
+  if (target != speed) {
+    if (target == 0)
+      _drive.setSpeed(0); // keeps FWD/ARC_*, so we carry on once the way clears
+    else // same curve as asked for, scaled from the request so it doesn't drift
+      _drive.drive(target, (int16_t)_requestedAngular * target / _requestedSpeed);
+  }
+  _governedSpeed = target;
+  _lastCommand = _drive.commandCount();
+  // if range gating is on, the sonar must see at least as far as it takes to stop from 
+  // the speed the user asked for -- otherwise a gated read() of 0 ("nothing in range") 
+  // would lift the limit while an obstacle is still inside stopping distance
+  _sonar.setLookahead(_stoppingDistance(_requestedSpeed));
+}
+
+uint16_t SpeedGovernor::_stoppingDistance(uint8_t speed) {
+  // reaction distance + braking distance at the speed we close in on obstacles
+  uint32_t v = (uint32_t)speed * _topSpeed / 100;
+  if (_closingSpeed > (long)v)
+    v = _closingSpeed;
+  uint32_t distance = v * _reaction / 1000 + (v * v) / (2UL * _braking) + 1;
+  return (distance < 0xFFFF) ? distance : 0xFFFF;
+}
+
+uint8_t SpeedGovernor::_limitForDistance(int distance) {
+  if (distance == 0) 
+    return 100;
+  int freeSpace = distance - (int)_sonar.clearanceThreshold;
+  if (freeSpace <= 0)
+    return 0;
+
+  // solve v*t + v^2/(2a) = d for v:  v = sqrt((a*t)^2 + 2*a*d) - a*t
+  uint32_t at = (uint32_t)_braking * _reaction / 1000;
+  uint32_t v = isqrt(at * at + 2UL * _braking * freeSpace) - at;
+
+  // the robot's own share of the closing speed is what we command; anything 
+  // beyond that is the obstacle moving towards us, so take it off the budget
+  uint32_t ownSpeed = (uint32_t)_governedSpeed * _topSpeed / 100;
+  if (_closingSpeed > (long)ownSpeed) {
+    uint32_t obstacleSpeed = _closingSpeed - ownSpeed;
+    v = (v > obstacleSpeed) ? v - obstacleSpeed : 0;
+  }
+  
+  uint32_t limit = v * 100 / _topSpeed;
+  return (limit > 100) ? 100 : limit;
+}
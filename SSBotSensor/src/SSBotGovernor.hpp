@@ -0,0 +1,52 @@
+#ifndef SSBOT_GOVERNOR_H
+#define SSBOT_GOVERNOR_H
+
+#include <Arduino.h>
+#include <SSBotMotor.hpp>
+#include <SSBotSensor.hpp>
+
+namespace SummerSpringBot {
+
+
+// ------------------ SPEED GOVERNOR ------------------
+
+// Caps forward speed so the robot can always stop in the free space the sonar sees:
+//     speed * reaction time + speed^2 / (2 * braking)  <=  distance - clearanceThreshold
+// This holds for fwd() and for forward curves alike (drive(linear, angular), 
+// curvatureDrive(), driveWheels(), LineSensorArray::steer()); a curve is slowed 
+// down without changing its shape. Turning on the spot and reversing are left alone.
+// Closing speed is estimated from how fast the sonar distance shrinks, so an obstacle 
+// moving towards the robot also slows it down. Lets the robot cruise fast in open 
+// space and brake early near obstacles. Call update() every loop(). With 
+// Sonar::setRangeGating(), update() also tells the sonar how far ahead it must look.
+class SpeedGovernor {
+  public:
+    // topSpeed:  how fast the robot goes at drive(100), in cm/s
+    // braking:   how hard it can decelerate, in cm/s^2
+    // reaction:  time between sonar readings plus motor response, in ms
+    SpeedGovernor(DifferentialDrive& drive, Sonar& sonar, 
+                  unsigned int topSpeed=100, unsigned int braking=200, unsigned int reaction=60);
+    void update();
+    // current forward speed limit, 0-100
+    uint8_t speedLimit();
+    // filtered rate the sonar distance is shrinking, in cm/s (negative = opening up)
+    int closingSpeed();
+
+  private:
+    DifferentialDrive& _drive;
+    Sonar& _sonar;
+    const unsigned int _topSpeed, _braking, _reaction;
+    unsigned long _lastReadTime;
+    int _lastDistance, _closingSpeed;
+    uint8_t _speedLimit, _requestedSpeed, _governedSpeed;
+    int8_t _requestedAngular;
+    uint8_t _lastCommand; // the drive's commandCount() after our last look
+    bool _movingForward();
+    uint8_t _limitForDistance(int distance);
+    uint16_t _stoppingDistance(uint8_t speed);
+};
+
+
+} // end of namespace SummerSpringBot
+
+#endif
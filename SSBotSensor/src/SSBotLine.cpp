@@ -0,0 +1,153 @@
+#include <SSBotLine.hpp>
+#include <SSBotFootprint.hpp>
+
+using namespace SummerSpringBot;
+
+#ifdef __AVR__
+static_assert(sizeof(LineSensorArray) <= LINE_SENSOR_ARRAY_SIZE_BUDGET, "LineSensorArray is over its RAM budget (SSBotFootprint.hpp)");
+#endif
+
+// a calibrated reading above this counts as seeing the line
+#define LINE_DETECT_THRESHOLD 200
+// readings below this are treated as floor and left out of the position average
+#define LINE_NOISE_THRESHOLD 50
+
+//================  LINE SENSOR ARRAY =================
+
+LineSensorArray::LineSensorArray(const uint8_t* pins, uint8_t numSensors, SensorType type) : 
+  _pins(pins), _numSensors(min(numSensors, MAX_LINE_SENSORS)), _type(type) {
+  _inverted = false;
+  _lineDetected = false;
+  _port = NULL;
+  _lastPosition = 0;
+  resetCalibration();
+}
+
+bool LineSensorArray::init() {
+  if (_numSensors == 0)
+    return false;
+
+  if (_type == DIGITAL) {
+    uint8_t port = digitalPinToPort(_pins[0]);
+    for (uint8_t i = 0; i < _numSensors; i++) {
+      if (digitalPinToPort(_pins[i]) != port)
+        return false;
+      pinMode(_pins[i], INPUT);
+      _masks[i] = digitalPinToBitMask(_pins[i]);
+    }
+    _port = portInputRegister(port);
+  } else {
+    for (uint8_t i = 0; i < _numSensors; i++) {
+      int8_t slot = AnalogSampler::addChannel(_pins[i]);
+      if (slot < 0)
+        return false;
+      _masks[i] = slot;
+    }
+    AnalogSampler::start();
+  }
+  _lastPosition = (_numSensors - 1) * (LINE_SENSOR_MAX / 2);
+  return true;
+}
+
+void LineSensorArray::setInverted(bool inverted) {
+  _inverted = inverted;
+}
+
+void LineSensorArray::resetCalibration() {
+  // until calibrated, use the full raw range
+  uint16_t rawMax = (_type == DIGITAL) ? 1 : 1023;
+  for (uint8_t i = 0; i < MAX_LINE_SENSORS; i++) {
+    _calMin[i] = 0;
+    _calMax[i] = rawMax;
+  }
+  _calibrated = false;
+}
+
+void LineSensorArray::calibrate() {
+  // straight after init() the sampler hasn't read every sensor yet: a 0 from a 
+  // slot not read yet would become a _calMin no floor reading ever gets down to
+  if (_type == ANALOG && !AnalogSampler::ready())
+    return;
+  uint16_t raw[MAX_LINE_SENSORS];
+  _readRaw(raw);
+  for (uint8_t i = 0; i < _numSensors; i++) {
+    // the first call replaces the default full range
+    if (!_calibrated || raw[i] < _calMin[i]) _calMin[i] = raw[i];
+    if (!_calibrated || raw[i] > _calMax[i]) _calMax[i] = raw[i];
+  }
+  _calibrated = true;
+}
+
+void LineSensorArray::_readRaw(uint16_t* raw) {
+  if (_type == DIGITAL) {
+    uint8_t port = *_port; // every sensor in one read
+    for (uint8_t i = 0; i < _numSensors; i++)
+      raw[i] = (port & _masks[i]) ? 1 : 0;
+  } else {
+    for (uint8_t i = 0; i < _numSensors; i++)
+      raw[i] = AnalogSampler::read(_masks[i]);
+  }
+}
+
+void LineSensorArray::read(uint16_t* values) {
+  _readRaw(values);
+  for (uint8_t i = 0; i < _numSensors; i++) {
+    uint16_t lo = _calMin[i], hi = _calMax[i];
+    uint16_t v = values[i];
+    if (hi <= lo)
+      v = 0;
+    else if (v <= lo)
+      v = 0;
+    else if (v >= hi)
+      v = LINE_SENSOR_MAX;
+    else
+      v = (uint32_t)(v - lo) * LINE_SENSOR_MAX / (hi - lo);
+    values[i] = _inverted ? LINE_SENSOR_MAX - v : v;
+  }
+}
+
+uint16_t LineSensorArray::readLine() {
+  uint16_t values[MAX_LINE_SENSORS];
+  read(values);
+
+  uint32_t weighted = 0;
+  uint16_t total = 0;
+  _lineDetected = false;
+  for (uint8_t i = 0; i < _numSensors; i++) {
+    uint16_t v = values[i];
+    if (v > LINE_DETECT_THRESHOLD)
+      _lineDetected = true;
+    if (v > LINE_NOISE_THRESHOLD) {
+      weighted += (uint32_t)v * i * LINE_SENSOR_MAX;
+      total += v;
+    }
+  }
+
+  if (!_lineDetected) {
+    // lost it: report whichever end it was last closer to, so steering keeps turning that way
+    uint16_t center = (_numSensors - 1) * (LINE_SENSOR_MAX / 2);
+    return (_lastPosition < center) ? 0 : (_numSensors - 1) * LINE_SENSOR_MAX;
+  }
+  _lastPosition = weighted / total;
+  return _lastPosition;
+}
+
+int16_t LineSensorArray::lineError() {
+  return (int16_t)readLine() - (int16_t)((_numSensors - 1) * (LINE_SENSOR_MAX / 2));
+}
+
+bool LineSensorArray::lineDetected() {
+  return _lineDetected;
+}
+
+void LineSensorArray::steer(DifferentialDrive& drive, uint8_t speed, uint8_t gain) {
+  int16_t error = lineError();
+  int16_t fullScale = (_numSensors - 1) * (LINE_SENSOR_MAX / 2);
+  if (fullScale == 0)
+    fullScale = 1;
+  // line to the right (error > 0) -> speed up left wheel, slow down right wheel
+  int16_t correction = (int32_t)error * gain / fullScale;
+  int16_t left = constrain(speed + correction, -100, 100);
+  int16_t right = constrain(speed - correction, -100, 100);
+  drive.driveWheels(left, right);
+}
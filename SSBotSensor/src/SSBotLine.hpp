@@ -0,0 +1,63 @@
+#ifndef SSBOT_LINE_H
+#define SSBOT_LINE_H
+
+#include <Arduino.h>
+#include <SSBotMotor.hpp>
+#include <SSBotAnalog.hpp>
+
+namespace SummerSpringBot {
+
+
+// ------------------ LINE SENSOR ARRAY ------------------
+
+#define MAX_LINE_SENSORS 8
+// calibrated reading of a sensor right over the line
+#define LINE_SENSOR_MAX 1000
+
+// Row of reflectance sensors, left to right, for line following.
+//   DIGITAL: on/off sensor modules. All pins must be on the same port (e.g. 2-7 or 
+//            8-13 on an Uno) so the whole row is read with one port read.
+//   ANALOG:  sensors on A0-A7, sampled in the background by AnalogSampler, so 
+//            reading never waits on the ADC.
+class LineSensorArray {
+  public:
+    enum SensorType : uint8_t {DIGITAL, ANALOG};
+    LineSensorArray(const uint8_t* pins, uint8_t numSensors, SensorType type=ANALOG);
+    // returns false if the pins can't be used (too many, or digital pins on different ports)
+    bool init();
+    // for a light line on a dark floor
+    void setInverted(bool inverted);
+
+    // call repeatedly while sweeping the sensors back and forth over the line
+    void calibrate();
+    void resetCalibration();
+
+    // calibrated readings, 0 (floor) to LINE_SENSOR_MAX (line)
+    void read(uint16_t* values);
+    // line position: 0 under the leftmost sensor, 1000 under the next, ... 
+    // If the line is lost, returns the end it was last seen at.
+    uint16_t readLine();
+    // how far the line is from center: negative = line is to the left
+    int16_t lineError();
+    bool lineDetected();
+
+    // follow the line: slows the wheel on the side the line is on. gain is the 
+    // wheel-speed difference (in %) when the line is under the outermost sensor.
+    void steer(DifferentialDrive& drive, uint8_t speed, uint8_t gain=50);
+
+  private:
+    const uint8_t* _pins;
+    const uint8_t _numSensors;
+    const SensorType _type;
+    bool _inverted, _lineDetected, _calibrated;
+    volatile uint8_t* _port;        // DIGITAL: input register all pins share
+    uint8_t _masks[MAX_LINE_SENSORS]; // DIGITAL: bit mask, ANALOG: AnalogSampler slot
+    uint16_t _calMin[MAX_LINE_SENSORS], _calMax[MAX_LINE_SENSORS];
+    uint16_t _lastPosition;
+    void _readRaw(uint16_t* raw);
+};
+
+
+} // end of namespace SummerSpringBot
+
+#endif
@@ -0,0 +1,143 @@
+#include <SSBotScript.hpp>
+#include <SSBotFootprint.hpp>
+
+using namespace SummerSpringBot;
+
+#ifdef __AVR__
+static_assert(sizeof(MotionScript) <= MOTION_SCRIPT_SIZE_BUDGET, "MotionScript is over its RAM budget (SSBotFootprint.hpp)");
+#endif
+static_assert(sizeof(MotionStep) == 4, "receive() counts upload bytes with a 2-bit field");
+
+// upper bound on instant steps (LOOP) run back-to-back in one tick, so a script 
+// that only loops on itself can't hang loop()
+#define MAX_INSTANT_STEPS 8
+
+//================  MOTION SCRIPT =================
+
+MotionScript::MotionScript(DifferentialDrive& drive, Sonar& sonar) : _drive(drive), _sonar(sonar) {
+  _script = NULL;
+  _running = false;
+  _pc = 0;
+  _loopCount = 0;
+  _uploadBuffer = NULL;
+  _uploadMaxSteps = 0;
+  _uploadSteps = 0;
+  _uploadOffset = 0;
+}
+
+void MotionScript::run(const MotionStep* script, bool inProgmem) {
+  _script = script;
+  _inProgmem = inProgmem;
+  _loopCount = 0;
+  _running = true;
+  _pc = 0xFF; // _startNextStep() pre-increments, wrapping round to step 0
+  _startNextStep();
+}
+
+void MotionScript::abort() {
+  _running = false;
+  _drive.stop();
+}
+
+bool MotionScript::isRunning() {
+  return _running;
+}
+
+uint8_t MotionScript::currentStep() {
+  return _pc;
+}
+
+void MotionScript::tick() {
+  if (!_running)
+    return;
+
+  switch (_step.op) {
+    case OP_DRIVE:
+    case OP_TURN_LEFT:
+    case OP_TURN_RIGHT:
+    case OP_STOP:
+      if (millis() - _stepStartTime < _step.param)
+        return;
+      break;
+    case OP_WAIT_SONAR: {
+      unsigned int distance = _sonar.read(); // 0 = nothing in range
+      if (distance == 0 || distance >= _step.param)
+        return;
+      break;
+    }
+  }
+  _startNextStep();
+}
+
+void MotionScript::_fetch(uint8_t index) {
+  if (_inProgmem)
+    memcpy_P(&_step, &_script[index], sizeof(MotionStep));
+  else
+    _step = _script[index];
+}
+
+void MotionScript::_startNextStep() {
+  for (uint8_t i = 0; i < MAX_INSTANT_STEPS; i++) {
+    _fetch(++_pc);
+    _stepStartTime = millis();
+    switch (_step.op) {
+      case OP_DRIVE:
+        _drive.drive(_step.arg);
+        return;
+      case OP_TURN_LEFT:
+        _drive.turnLeft(_step.arg);
+        return;
+      case OP_TURN_RIGHT:
+        _drive.turnRight(_step.arg);
+        return;
+      case OP_STOP:
+        _drive.stop();
+        return;
+      case OP_WAIT_SONAR:
+        return;
+      case OP_LOOP:
+        if (_step.arg < 0 || _step.arg > _pc) { // only backwards, into steps already run
+          abort();
+          return;
+        }
+        if (_step.param == 0 || ++_loopCount < _step.param) {
+          _pc = _step.arg - 1; // jump; the next fetch pre-increments
+        } else {
+          _loopCount = 0;
+        }
+        break; // LOOP takes no time -- carry straight on to the next step
+      case OP_END:
+      default:
+        abort();
+        return;
+    }
+  }
+  // still on a LOOP step; keep going next tick
+}
+
+bool MotionScript::beginUpload(MotionStep* buffer, uint8_t maxSteps) {
+  _uploadBuffer = (maxSteps > 0) ? buffer : NULL;
+  _uploadMaxSteps = maxSteps;
+  _uploadSteps = 0;
+  _uploadOffset = 0;
+  return _uploadBuffer != NULL;
+}
+
+bool MotionScript::receive(uint8_t byte) {
+  if (_uploadBuffer == NULL)
+    return false;
+  MotionStep& step = _uploadBuffer[_uploadSteps];
+  ((uint8_t*) &step)[_uploadOffset] = byte;
+  if (++_uploadOffset != 0) // 2-bit counter: wraps to 0 after the 4th byte
+    return false;
+
+  // a full step arrived
+  if (step.op == OP_LOOP && (step.arg < 0 || step.arg > _uploadSteps))
+    step.op = OP_END; // would jump outside the script
+  if (++_uploadSteps == _uploadMaxSteps)
+    step.op = OP_END; // out of room: force an END so the script is still safe to run
+  if (step.op != OP_END)
+    return false;
+  _uploadBuffer = NULL;
+  return true;
+}
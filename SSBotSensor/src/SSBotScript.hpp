@@ -0,0 +1,78 @@
+#ifndef SSBOT_SCRIPT_H
+#define SSBOT_SCRIPT_H
+
+#include <Arduino.h>
+#include <SSBotMotor.hpp>
+#include <SSBotSensor.hpp>
+
+namespace SummerSpringBot {
+
+
+// ------------------ MOTION SCRIPTS ------------------
+
+// A motion script is an array of 4-byte steps ending with MOTION_END(). Keep it in 
+// flash with PROGMEM, or upload it over serial into a RAM buffer.
+enum MotionOp : uint8_t {
+    OP_END = 0,
+    OP_DRIVE,       // drive at velocity arg (-100 to 100) for param ms
+    OP_TURN_LEFT,   // rotate CCW at speed arg for param ms
+    OP_TURN_RIGHT,  // rotate CW at speed arg for param ms
+    OP_STOP,        // stop, then wait param ms
+    OP_WAIT_SONAR,  // keep doing the previous step until sonar reads closer than param cm
+    OP_LOOP,        // jump back to step arg (this step or an earlier one), param times 
+                    // in total (0 = forever); a jump anywhere else ends the script
+};
+
+struct MotionStep {
+    uint8_t op;
+    int8_t arg;
+    uint16_t param;
+};
+
+#define MOTION_DRIVE(velocity, ms)   {OP_DRIVE, (velocity), (ms)}
+#define MOTION_TURN_LEFT(speed, ms)  {OP_TURN_LEFT, (speed), (ms)}
+#define MOTION_TURN_RIGHT(speed, ms) {OP_TURN_RIGHT, (speed), (ms)}
+#define MOTION_STOP(ms)              {OP_STOP, 0, (ms)}
+#define MOTION_WAIT_SONAR(cm)        {OP_WAIT_SONAR, 0, (cm)}
+#define MOTION_LOOP(toStep, times)   {OP_LOOP, (toStep), (times)}
+#define MOTION_END()                 {OP_END, 0, 0}
+
+// Runs a motion script without blocking: call tick() every loop().
+// Loops can't be nested (a script has a single loop counter).
+class MotionScript {
+  public:
+    MotionScript(DifferentialDrive& drive, Sonar& sonar);
+    void run(const MotionStep* script, bool inProgmem=true);
+    void abort();
+    void tick();
+    bool isRunning();
+    uint8_t currentStep();
+
+    // upload a script over serial: feed it raw bytes (4 per step, param little-endian);
+    // receive() returns true once MOTION_END() arrives or the buffer is full. The last 
+    // step that fits, and any LOOP that doesn't jump back, are turned into END so the 
+    // script is always safe to run. beginUpload() returns false if maxSteps is 0.
+    bool beginUpload(MotionStep* buffer, uint8_t maxSteps);
+    bool receive(uint8_t byte);
+
+  private:
+    DifferentialDrive& _drive;
+    Sonar& _sonar;
+    const MotionStep* _script;
+    uint8_t _inProgmem : 1;
+    uint8_t _running : 1;
+    uint8_t _uploadOffset : 2;  // byte within the step being uploaded
+    uint8_t _pc;
+    uint16_t _loopCount;        // same type as a LOOP's param
+    MotionStep _step;
+    unsigned long _stepStartTime;
+    MotionStep* _uploadBuffer;
+    uint8_t _uploadMaxSteps, _uploadSteps;
+    void _fetch(uint8_t index);
+    void _startNextStep();
+};
+
+
+} // end of namespace SummerSpringBot
+
+#endif
@@ -1,11 +1,21 @@
 
 #include <IRremote.hpp>
 #include <SSBotSensor.hpp>
+#include <SSBotFootprint.hpp>
 
 using namespace SummerSpringBot;
 
+#ifdef __AVR__
+static_assert(sizeof(Sonar) <= sizeof(NewPing) + SONAR_SIZE_BUDGET, "Sonar is over its RAM budget (SSBotFootprint.hpp)");
+static_assert(sizeof(IRSensor) <= IR_SENSOR_SIZE_BUDGET, "IRSensor is over its RAM budget (SSBotFootprint.hpp)");
+#endif
+
 #define IR_SENSOR_PERIOD 20 // ms
 
+#define RANGE_GATE_PERIOD     30  // ms between gated pings; lets echoes from far walls die out
+#define RANGE_GATE_MARGIN     10  // cm past clearanceThreshold + lookahead that is always watched
+#define RANGE_GATE_WIDEN_EVERY 8  // every Nth gated ping looks out to full range
+
 //================  SONAR =================
 
 Sonar::Sonar(uint8_t trigPin, uint8_t echoPin, unsigned int clearance, unsigned long Hz) : 
@@ -13,46 +23,141 @@ Sonar::Sonar(uint8_t trigPin, uint8_t echoPin, unsigned int clearance, unsigned
   // _sensor = NewPing(trigPin, echoPin, 500);
   // _sensorPeriodMillis = 1000.0 / Hz;
   _lastReadTime = 0;
+  _lastDistance = 0;
+  _rangeGating = false;
+  _lookahead = 0;
+  _gatedReads = 0;
 }
 
 bool Sonar::clearAhead() {
-  return (read() > clearanceThreshold);
+  int distance = read();
+  return (distance == 0) || ((unsigned int)distance > clearanceThreshold); // 0 = nothing in range
 }
 
 void Sonar::init(){
   pinMode(_trigPin, OUTPUT);
   pinMode(_echoPin, INPUT);
-  _sensor.ping();
+  // no warm-up ping here: a ping with no echo blocks for ~30ms and delays startup
+  RobotConfig config;
+  if (loadRobotConfig(config))
+    applyConfig(config);
+}
+
+void Sonar::applyConfig(const RobotConfig& config) {
+  clearanceThreshold = config.clearanceThreshold;
+}
+
+void Sonar::getConfig(RobotConfig& config) {
+  config.clearanceThreshold = clearanceThreshold;
 }
 
 int Sonar::read(){
-    if (millis() - _lastReadTime > 50){
+    if (!_rangeGating) {
+        if (millis() - _lastReadTime > _sensorPeriodMillis){
+            _lastReadTime = millis();
+            // Send ping, get distance in cm (0 = outside set distance range)
+            _lastDistance = _sensor.convert_cm(_sensor.ping_median(5, MAX_SENSOR_DISTANCE)); 
+        }
+    } else if (millis() - _lastReadTime >= RANGE_GATE_PERIOD) {
         _lastReadTime = millis();
-        _lastDistance = _sensor.convert_cm(_sensor.ping_median()); // Send ping, get distance in cm (0 = outside set distance range)
+        // NewPing keeps the last max distance it was given, so always pass one explicitly
+        unsigned int maxDistance = _gateDistance();
+        if (++_gatedReads >= RANGE_GATE_WIDEN_EVERY) {
+            _gatedReads = 0;
+            maxDistance = MAX_SENSOR_DISTANCE;
+        }
+        _lastDistance = _sensor.convert_cm(_sensor.ping(maxDistance));
     }
     return _lastDistance;
 }
 
+void Sonar::setRangeGating(bool enabled) {
+    _rangeGating = enabled;
+    _gatedReads = 0;
+}
+
+void Sonar::setLookahead(uint16_t cm) {
+    _lookahead = cm;
+}
+
+unsigned int Sonar::_gateDistance() {
+    uint32_t gate = (uint32_t)clearanceThreshold + RANGE_GATE_MARGIN + _lookahead;
+    return (gate < MAX_SENSOR_DISTANCE) ? gate : MAX_SENSOR_DISTANCE;
+}
+
+unsigned long Sonar::readTime(){
+    return _lastReadTime;
+}
+
 
 //================  IR REMOTE   =================
 
 
-IRSensor::IRSensor(uint8_t IRpin) : _IRpin(IRpin){}
+IRSensor::IRSensor(uint8_t IRpin, const uint8_t* keymap) : _IRpin(IRpin){
+  memcpy(_keymap, keymap, NUM_REMOTE_KEYS);
+  _timeOfLastInterrupt = 0;
+  _address = IR_ANY_ADDRESS;
+  _pairing = false;
+}
 
 void IRSensor::init()
 {
     IrReceiver.begin(_IRpin, ENABLE_LED_FEEDBACK);
+    RobotConfig config;
+    if (loadRobotConfig(config))
+      applyConfig(config);
+}
+
+void IRSensor::applyConfig(const RobotConfig& config) {
+  memcpy(_keymap, config.keymap, NUM_REMOTE_KEYS);
+  _address = config.irAddress;
+}
+
+void IRSensor::getConfig(RobotConfig& config) {
+  memcpy(config.keymap, _keymap, NUM_REMOTE_KEYS);
+  config.irAddress = _address;
+}
+
+void IRSensor::setAddress(uint16_t address) {
+  _address = address;
+  _pairing = false;
+}
+
+uint16_t IRSensor::address() {
+  return _address;
+}
+
+void IRSensor::pair() {
+  _address = IR_ANY_ADDRESS; // otherwise only the remote we already have could pair
+  _pairing = true;
+}
+
+bool IRSensor::isPairing() {
+  return _pairing;
+}
+
+IRCommand IRSensor::key(RemoteKey control) {
+  return (IRCommand) _keymap[control];
 }
 
 bool IRSensor::commandReceived() {
-  if ((millis()-_timeOfLastInterrupt) < IR_SENSOR_PERIOD) 
+  if ((uint16_t)((uint16_t)millis() - _timeOfLastInterrupt) < IR_SENSOR_PERIOD) 
     return false;
   else {
     _timeOfLastInterrupt = millis();
-    bool available = IrReceiver.decode();
+    if (!IrReceiver.decode())
+      return false;
     IrReceiver.resume(); // re-enable listening for next command
-    return ( available && (!(IrReceiver.decodedIRData.flags & IRDATA_FLAGS_IS_REPEAT))
-             && (IrReceiver.decodedIRData.command > 0) );
+    // drop frames meant for other robots first -- that's most of them in a full room
+    if (_address != IR_ANY_ADDRESS && IrReceiver.decodedIRData.address != _address)
+      return false;
+    if ((IrReceiver.decodedIRData.flags & IRDATA_FLAGS_IS_REPEAT) || (IrReceiver.decodedIRData.command == 0))
+      return false;
+    if (_pairing) {
+      _address = IrReceiver.decodedIRData.address;
+      _pairing = false;
+    }
+    return true;
   }
 }
 
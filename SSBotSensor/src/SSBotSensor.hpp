@@ -5,6 +5,7 @@
 #include <string.h>
 #include "Arduino.h"
 #include <NewPing.h>
+#include <SSBotConfig.hpp>
 
 #define DECODE_NEC      
 #define USE_IRREMOTE_HPP_AS_PLAIN_INCLUDE
@@ -19,15 +20,36 @@ namespace SummerSpringBot {
 class Sonar{
     NewPing _sensor;
     const uint8_t _trigPin, _echoPin;
-    const unsigned long _sensorPeriodMillis;
+    const uint16_t _sensorPeriodMillis;
     unsigned long _lastReadTime;
     unsigned int _lastDistance;
+    uint8_t _rangeGating : 1;
+    uint8_t _gatedReads : 4;   // counts up to RANGE_GATE_WIDEN_EVERY
+    uint16_t _lookahead;
+    unsigned int _gateDistance();
   public:
-    const unsigned int clearanceThreshold;
+    unsigned int clearanceThreshold;
     Sonar(uint8_t trigPin, uint8_t echoPin, unsigned int clearanceThreshold=10, unsigned long Hz=20);
     bool clearAhead();
+    // loads clearanceThreshold from EEPROM if a config is stored there
     void init();
+    void applyConfig(const RobotConfig& config);
+    // copy the settings in use now (clearanceThreshold) into config
+    void getConfig(RobotConfig& config);
+    // distance in cm, or 0 if nothing is in range
     int read();
+    // millis() when the distance returned by read() was measured
+    unsigned long readTime();
+
+    // Range gating: only listen for echoes out to a little past where an obstacle 
+    // would matter at the current speed, so a ping with no echo returns in a few ms 
+    // instead of ~30ms, and ping often. Every few pings the full range is checked so 
+    // far-away obstacles are still seen. While gated, read() returns 0 when nothing 
+    // is inside the gate.
+    void setRangeGating(bool enabled);
+    // how far past clearanceThreshold an obstacle matters right now, in cm (e.g. the
+    // distance needed to stop from the current speed); widens the gate
+    void setLookahead(uint16_t cm);
 };
 
 
@@ -46,23 +68,9 @@ enum IRCommand {
       CMD_7,        CMD_8,      CMD_9,
     };
 
-class IRSensor {
-    const uint8_t _IRpin;
-    unsigned long _timeOfLastInterrupt;
-  public:
-    IRSensor(uint8_t IRpin);
-    void init();
-    bool commandReceived();
-    IRCommand query();
-    static bool isValid(IRCommand command);
-    static String str(IRCommand command);
-  private:
-    IRCommand _currentCommand();
-    static String _raw2str(uint32_t command);
-
-};
-
 // 2-player Button Configurations
+// These are only the defaults: if a keymap was saved with saveRobotConfig(), 
+// IRSensor::init() uses that instead (eraseRobotConfig() to go back to these).
 #ifdef BLUE_TEAM
 #define FWD_BUTTON    CMD_CH
 #define REV_BUTTON    CMD_VOLUP
@@ -87,6 +95,45 @@ class IRSensor {
 #define ENABLE_BUTTON CMD_PLAY
 #endif
 
+// keymap matching the team chosen above, indexed by RemoteKey
+static const uint8_t DEFAULT_KEYMAP[NUM_REMOTE_KEYS] = {
+    FWD_BUTTON, REV_BUTTON, LEFT_BUTTON, RIGHT_BUTTON, STOP_BUTTON, ENABLE_BUTTON
+};
+
+class IRSensor {
+    const uint8_t _IRpin;
+    uint16_t _timeOfLastInterrupt; // low 16 bits of millis() are plenty for a 20ms period
+    uint8_t _keymap[NUM_REMOTE_KEYS];
+    uint16_t _address;
+    bool _pairing;
+  public:
+    IRSensor(uint8_t IRpin, const uint8_t* keymap = DEFAULT_KEYMAP);
+    // loads the button keymap from EEPROM if a config is stored there, 
+    // replacing the keymap given to the constructor
+    void init();
+    void applyConfig(const RobotConfig& config);
+    // copy the settings in use now (keymap, address) into config
+    void getConfig(RobotConfig& config);
+    bool commandReceived();
+    IRCommand query();
+    // which button is currently mapped to a control, e.g. key(KEY_FWD)
+    IRCommand key(RemoteKey control);
+
+    // Only listen to one remote (by its NEC address) so many robots can share a room;
+    // frames from other remotes are dropped before they are looked at any further.
+    void setAddress(uint16_t address=IR_ANY_ADDRESS);
+    uint16_t address();
+    // forget the current remote and listen to whichever remote sends the next 
+    // button press from now on
+    void pair();
+    bool isPairing();
+    static bool isValid(IRCommand command);
+    static String str(IRCommand command);
+  private:
+    IRCommand _currentCommand();
+    static String _raw2str(uint32_t command);
+
+};
 
 
 } // end of namespace SummerSpringBot
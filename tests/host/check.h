@@ -0,0 +1,24 @@
+// Tiny assertion helpers for the host tests: a failed CHECK prints where and 
+// carries on, and main() returns checkResult() so make stops on failure.
+#pragma once
+#include <stdio.h>
+
+static int checkFailures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+        checkFailures++; \
+    } } while (0)
+
+#define CHECK_EQ(actual, expected) do { \
+    long _a = (long)(actual), _e = (long)(expected); \
+    if (_a != _e) { \
+        printf("%s:%d: %s is %ld, expected %ld\n", __FILE__, __LINE__, #actual, _a, _e); \
+        checkFailures++; \
+    } } while (0)
+
+static inline int checkResult(const char* name) {
+    printf("%s: %s\n", name, checkFailures ? "FAILED" : "ok");
+    return checkFailures ? 1 : 0;
+}
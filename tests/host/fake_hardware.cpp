@@ -0,0 +1,153 @@
+#include <EEPROM.h>
+#include <NewPing.h>
+#include <IRremote.hpp>
+#include "fake_hardware.h"
+
+volatile uint8_t _pinregs[4];
+volatile uint8_t TCCR1A, TCCR1B, ADMUX, ADCSRB, DIDR0, SREG;
+volatile uint16_t ICR1, OCR1A, OCR1B, TCNT1, ADC;
+AdcControlRegister ADCSRA;
+
+unsigned long fakeMicros;
+int fakePWM[32];
+int fakeDigital[32];
+uint8_t fakeEEPROM[1024];
+unsigned int fakeSonarDistance;
+unsigned int fakeSonarLastMax;
+unsigned long fakeSonarPings;
+bool fakeCoreTiming;
+
+// rough cost of each Arduino core call on a 16 MHz Uno, charged to the fake 
+// clock when fakeCoreTiming is on
+const unsigned long PIN_MODE_US = 4, DIGITAL_WRITE_US = 4, ANALOG_WRITE_US = 8;
+const unsigned long EEPROM_READ_US = 1, SERIAL_BEGIN_US = 20;
+
+static void charge(unsigned long us) {
+    if (fakeCoreTiming)
+        fakeMicros += us;
+}
+
+static const int IR_QUEUE_LENGTH = 256;
+static IRData irQueue[IR_QUEUE_LENGTH];
+static unsigned long irArrival[IR_QUEUE_LENGTH]; // fakeMicros it arrives at, 0 = already there
+static int irQueued, irNext;
+unsigned long fakeIRDropped;
+
+void fakeReset() {
+    fakeMicros = 1000000; // well past boot, so "time since 0" checks pass
+    memset(fakePWM, 0, sizeof(fakePWM));
+    memset(fakeDigital, 0, sizeof(fakeDigital));
+    memset(fakeEEPROM, 0xFF, sizeof(fakeEEPROM));
+    memset((void*)_pinregs, 0, sizeof(_pinregs));
+    fakeSonarDistance = 0;
+    fakeSonarLastMax = 0;
+    fakeSonarPings = 0;
+    fakeCoreTiming = false;
+    irQueued = irNext = 0;
+    fakeIRDropped = 0;
+    TCCR1A = TCCR1B = 0;
+    ICR1 = OCR1A = OCR1B = 0;
+}
+
+void fakeAdvanceMillis(unsigned long ms) {
+    fakeMicros += ms * 1000;
+}
+
+int fakeWheel(uint8_t pwmPin, uint8_t fwdPin, uint8_t revPin) {
+    int dir = fakeDigital[fwdPin] ? 1 : (fakeDigital[revPin] ? -1 : 0);
+    return dir * fakePWM[pwmPin];
+}
+
+void fakeADCConvert(uint16_t value) {
+    ADC = value;
+    ADC_vect();
+}
+
+//------------------ Arduino core ------------------
+
+long map(long x, long inMin, long inMax, long outMin, long outMax) {
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+void pinMode(uint8_t, uint8_t) { charge(PIN_MODE_US); }
+void digitalWrite(uint8_t pin, uint8_t value) { fakeDigital[pin] = value; charge(DIGITAL_WRITE_US); }
+int digitalRead(uint8_t pin) { return fakeDigital[pin]; }
+int analogRead(uint8_t) { return 0; }
+void analogWrite(uint8_t pin, int value) { fakePWM[pin] = value; charge(ANALOG_WRITE_US); }
+unsigned long millis() { return fakeMicros / 1000; }
+unsigned long micros() { return fakeMicros; }
+void delay(unsigned long ms) { fakeAdvanceMillis(ms); }
+
+HardwareSerial Serial;
+void HardwareSerial::begin(unsigned long) { charge(SERIAL_BEGIN_US); }
+size_t HardwareSerial::write(uint8_t) { return 1; }
+int HardwareSerial::available() { return 0; }
+int HardwareSerial::read() { return -1; }
+int HardwareSerial::peek() { return -1; }
+
+EEPROMClass EEPROM;
+uint8_t EEPROMClass::read(int address) { charge(EEPROM_READ_US); return fakeEEPROM[address]; }
+void EEPROMClass::update(int address, uint8_t value) { fakeEEPROM[address] = value; }
+void EEPROMClass::write(int address, uint8_t value) { fakeEEPROM[address] = value; }
+
+//------------------ NewPing ------------------
+
+NewPing::NewPing(uint8_t, uint8_t, unsigned int) { }
+
+// like the real sensor: ~57us per cm of echo, or blocks until the max distance's
+// echo time runs out if nothing is in range
+unsigned int NewPing::ping(unsigned int maxDistance) {
+    if (maxDistance == 0)
+        maxDistance = MAX_SENSOR_DISTANCE;
+    fakeSonarLastMax = maxDistance;
+    fakeSonarPings++;
+    unsigned int cm = fakeSonarDistance;
+    if (cm > maxDistance)
+        cm = 0;
+    fakeMicros += cm ? cm * US_ROUNDTRIP_CM : maxDistance * US_ROUNDTRIP_CM + 500;
+    return cm * US_ROUNDTRIP_CM;
+}
+
+unsigned long NewPing::ping_median(uint8_t iterations, unsigned int maxDistance) {
+    unsigned long echo = 0;
+    for (uint8_t i = 0; i < iterations; i++)
+        echo = ping(maxDistance);
+    return echo;
+}
+
+unsigned int NewPing::convert_cm(unsigned int echoTime) {
+    return echoTime / US_ROUNDTRIP_CM;
+}
+
+//------------------ IRremote ------------------
+
+IRrecv IrReceiver;
+void IRrecv::begin(uint8_t, bool) { }
+void IRrecv::resume() { }
+bool IRrecv::decode() {
+    if (irNext >= irQueued || irArrival[irNext] > fakeMicros)
+        return false;
+    decodedIRData = irQueue[irNext++];
+    // like the real receiver: it stops listening once it holds a frame, so every 
+    // timed frame that came in while this one waited to be decoded is lost
+    while (irNext < irQueued && irArrival[irNext] != 0 && irArrival[irNext] <= fakeMicros) {
+        irNext++;
+        fakeIRDropped++;
+    }
+    return true;
+}
+
+void fakeQueueIR(uint16_t address, uint16_t command, uint8_t flags) {
+    fakeQueueIRAt(0, address, command, flags);
+}
+
+void fakeQueueIRAt(unsigned long arrivalMicros, uint16_t address, uint16_t command, uint8_t flags) {
+    if (irQueued < IR_QUEUE_LENGTH) {
+        IRData frame = {address, command, flags};
+        irArrival[irQueued] = arrivalMicros;
+        irQueue[irQueued++] = frame;
+    }
+}
+
+int fakeQueuedIR() {
+    return irQueued - irNext;
+}
@@ -0,0 +1,33 @@
+// Knobs and probes for the fake Arduino in stubs/. Every test starts with 
+// fakeReset(), which also blanks the EEPROM so no stored config gets loaded.
+#pragma once
+#include <Arduino.h>
+#include <IRremote.hpp>
+
+extern unsigned long fakeMicros;          // the clock; millis() is fakeMicros / 1000
+extern int fakePWM[32];                   // last analogWrite() per pin
+extern int fakeDigital[32];               // last digitalWrite() per pin
+extern uint8_t fakeEEPROM[1024];
+
+extern unsigned int fakeSonarDistance;    // cm to the obstacle, 0 = nothing there
+extern unsigned int fakeSonarLastMax;     // max distance passed to the last ping
+extern unsigned long fakeSonarPings;
+// charge the fake clock a typical Uno's time for each pin, EEPROM and Serial call 
+// (off after fakeReset(), so other tests only see time they advance themselves)
+extern bool fakeCoreTiming;
+
+void fakeReset();
+void fakeAdvanceMillis(unsigned long ms);
+// queue a frame for IrReceiver.decode() to return
+void fakeQueueIR(uint16_t address, uint16_t command, uint8_t flags = 0);
+// queue a frame that reaches the receiver at a set time (in order of arrival); 
+// frames that arrive while an earlier one is still waiting for decode() are lost
+void fakeQueueIRAt(unsigned long arrivalMicros, uint16_t address, uint16_t command, uint8_t flags = 0);
+extern unsigned long fakeIRDropped;       // timed frames lost that way
+int fakeQueuedIR();
+// finish one conversion on whatever channel ADMUX selects, with this reading
+void fakeADCConvert(uint16_t value);
+// signed wheel command seen on a motor's pins: +/- PWM duty
+int fakeWheel(uint8_t pwmPin, uint8_t fwdPin, uint8_t revPin);
+
+extern "C" void ADC_vect(void);
@@ -0,0 +1,96 @@
+// Minimal stand-in for the Arduino core, just enough to build SSBotMotor and
+// SSBotSensor on a PC. Pins, timers and the ADC are plain variables that the 
+// tests read and poke (see fake_hardware.h).
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#define F_CPU 16000000UL
+#define OUTPUT 1
+#define INPUT 0
+#define INPUT_PULLUP 2
+#define HIGH 1
+#define LOW 0
+
+#define PROGMEM
+#define F(s) (s)
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+#define pgm_read_word(p) (*(const uint16_t*)(p))
+#define memcpy_P memcpy
+#define strlen_P strlen
+#define __FlashStringHelper char
+
+#define digitalPinToPort(p) ((p) / 8)
+#define digitalPinToBitMask(p) (1 << ((p) % 8))
+#define portInputRegister(p) (&_pinregs[p])
+#define analogPinToChannel(p) (p)
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+#define A6 20
+#define A7 21
+
+#define bit(b) (1UL << (b))
+#define noInterrupts()
+#define interrupts()
+#define constrain(a, l, h) ((a) < (l) ? (l) : ((a) > (h) ? (h) : (a)))
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#define max(a, b) ((a) > (b) ? (a) : (b))
+#define abs(x) ((x) > 0 ? (x) : -(x))
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+extern volatile uint8_t _pinregs[4];
+
+long map(long x, long inMin, long inMax, long outMin, long outMax);
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+void analogWrite(uint8_t pin, int value);
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+
+class String : public std::string {
+  public:
+    String(const char* s = "") : std::string(s) {}
+};
+
+class Print {
+  public:
+    virtual size_t write(uint8_t b) = 0;
+    virtual size_t write(const uint8_t* b, size_t n) {
+        for (size_t i = 0; i < n; i++)
+            write(b[i]);
+        return n;
+    }
+    virtual int availableForWrite() { return 64; }
+};
+
+class Stream : public Print {
+  public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+};
+
+class HardwareSerial : public Stream {
+  public:
+    void begin(unsigned long baud);
+    size_t write(uint8_t b);
+    int available();
+    int read();
+    int peek();
+    operator bool() { return true; }
+};
+extern HardwareSerial Serial;
+
+#include <avr/io.h>
@@ -0,0 +1,14 @@
+#pragma once
+#include <Arduino.h>
+
+#define DROP_UNTIL_EMPTY 0
+
+struct BufferedOutput : public Stream {
+    void connect(Stream&) {}
+    void nextByteOut() {}
+    size_t write(uint8_t) { return 1; }
+    int available() { return 0; }
+    int read() { return -1; }
+    int peek() { return -1; }
+};
+#define createBufferedOutput(name, size, mode) BufferedOutput name;
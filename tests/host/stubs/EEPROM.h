@@ -0,0 +1,9 @@
+#pragma once
+#include <Arduino.h>
+
+struct EEPROMClass {
+    uint8_t read(int address);
+    void update(int address, uint8_t value);
+    void write(int address, uint8_t value);
+};
+extern EEPROMClass EEPROM;
@@ -0,0 +1,21 @@
+// Fake IRremote: decode() hands out the frames queued with fakeQueueIR().
+#pragma once
+#include <Arduino.h>
+
+#define ENABLE_LED_FEEDBACK true
+#define IRDATA_FLAGS_IS_REPEAT 0x01
+
+struct IRData {
+    uint16_t address;
+    uint16_t command;
+    uint8_t flags;
+};
+
+class IRrecv {
+  public:
+    void begin(uint8_t pin, bool ledFeedback);
+    bool decode();
+    void resume();
+    IRData decodedIRData;
+};
+extern IRrecv IrReceiver;
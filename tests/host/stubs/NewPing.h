@@ -0,0 +1,16 @@
+// Fake NewPing: echoes come from fakeSonarDistance, and each ping advances the
+// fake clock by as long as the real sensor would block.
+#pragma once
+#include <Arduino.h>
+
+#define MAX_SENSOR_DISTANCE 500
+#define US_ROUNDTRIP_CM 57
+#define NO_ECHO 0
+
+class NewPing {
+  public:
+    NewPing(uint8_t trigger, uint8_t echo, unsigned int maxDistance = MAX_SENSOR_DISTANCE);
+    unsigned int ping(unsigned int maxDistance = 0);
+    unsigned long ping_median(uint8_t iterations = 5, unsigned int maxDistance = 0);
+    static unsigned int convert_cm(unsigned int echoTime);
+};
@@ -0,0 +1,7 @@
+#pragma once
+#include <Arduino.h>
+
+struct SafeStringReader {
+    void connect(Stream&) {}
+};
+#define createSafeStringReader(name, size, delimiters) SafeStringReader name;
@@ -0,0 +1,5 @@
+#pragma once
+// ISRs become plain functions the tests can call to fake an interrupt
+#define ISR(vector) extern "C" void vector(void)
+#define cli()
+#define sei()
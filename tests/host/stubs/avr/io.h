@@ -0,0 +1,44 @@
+// ATmega328P registers used by the libraries, as plain variables
+#pragma once
+#include <stdint.h>
+
+#define __AVR_ATmega328P__
+
+extern volatile uint8_t TCCR1A, TCCR1B, ADMUX, ADCSRB, DIDR0, SREG;
+extern volatile uint16_t ICR1, OCR1A, OCR1B, TCNT1, ADC;
+
+// ADC conversions finish as soon as they start on the host (the test then calls
+// ADC_vect() itself), so ADSC never reads back as set
+struct AdcControlRegister {
+    uint8_t bits;
+    operator uint8_t() const { return bits & ~(1 << 6); }
+    AdcControlRegister& operator=(uint8_t v) { bits = v; return *this; }
+    AdcControlRegister& operator|=(uint8_t v) { bits |= v; return *this; }
+    AdcControlRegister& operator&=(uint8_t v) { bits &= v; return *this; }
+};
+extern AdcControlRegister ADCSRA;
+
+#define COM1A1 7
+#define COM1B1 5
+#define WGM10 0
+#define WGM11 1
+#define WGM12 3
+#define WGM13 4
+#define CS10 0
+#define CS11 1
+#define CS12 2
+#define REFS0 6
+#define REFS1 7
+#define ADEN 7
+#define ADSC 6
+#define ADATE 5
+#define ADIF 4
+#define ADIE 3
+#define ADPS2 2
+#define ADPS1 1
+#define ADPS0 0
+#define MUX3 3
+#define MUX2 2
+#define MUX1 1
+#define MUX0 0
+#define _BV(b) (1 << (b))
@@ -0,0 +1,3 @@
+#pragma once
+#define ATOMIC_RESTORESTATE 0
+#define ATOMIC_BLOCK(type) for (int _atomic = 1; _atomic; _atomic = 0)
@@ -0,0 +1,63 @@
+// Battery compensation: a robot cruising on one command keeps its speed as the
+// pack drains, and still reports the speed it was asked for
+#include <SSBotBattery.hpp>
+#include "fake_hardware.h"
+#include "check.h"
+
+using namespace SummerSpringBot;
+
+DifferentialDrive motors(11, 12, 10, 7, 8, 9);
+Battery battery(A5); // 2:1 divider, 6 V nominal
+
+// hold the pack at `millivolts` long enough for the filter to settle
+static void packAt(unsigned int millivolts) {
+  for (int i = 0; i < 200; i++) {
+    fakeADCConvert((uint32_t)millivolts * 1024 / 10000);
+    battery.update();
+  }
+}
+
+static void testCruiseCompensated() {
+  packAt(6000);
+  motors.fwd(50);
+  int fresh = fakeWheel(10, 11, 12);
+  CHECK(fresh >= 125 && fresh <= 130);
+
+  // no new commands from here on
+  packAt(5000);
+  int drained = fakeWheel(10, 11, 12);
+  CHECK(drained > fresh);
+  CHECK(drained >= 150 && drained <= 156); // 6/5 of the fresh PWM
+  CHECK_EQ(fakeWheel(9, 7, 8), drained);
+  CHECK_EQ(motors.getVelocity(), 50);
+
+  packAt(4000);
+  int flat = fakeWheel(10, 11, 12);
+  CHECK(flat > drained);
+  CHECK_EQ(motors.getVelocity(), 50);
+  printf("  fwd(50) once: PWM %d at 6.0 V, %d at 5.0 V, %d at 4.0 V\n", fresh, drained, flat);
+
+  // turning compensation off goes straight back to the plain duty
+  battery.setCompensationEnabled(false);
+  CHECK_EQ(fakeWheel(10, 11, 12), fresh);
+  battery.setCompensationEnabled(true);
+  CHECK_EQ(fakeWheel(10, 11, 12), flat);
+}
+
+static void testNeverPastMaxPWM() {
+  packAt(3000);
+  motors.fwd(100);
+  CHECK_EQ(fakeWheel(10, 11, 12), 255);
+  CHECK_EQ(motors.getVelocity(), 100);
+  motors.stop();
+  CHECK_EQ(fakeWheel(10, 11, 12), 0);
+}
+
+int main() {
+  fakeReset();
+  motors.init();
+  CHECK(battery.init());
+  testCruiseCompensated();
+  testNeverPastMaxPWM();
+  return checkResult("test_battery");
+}
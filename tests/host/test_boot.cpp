@@ -0,0 +1,59 @@
+// Time from reset to the first motor command, for the startup order the examples 
+// use (motors, then sensors, then serial), on the fake clock with typical Uno costs
+#include <SSBotMotor.hpp>
+#include <SSBotSensor.hpp>
+#include "fake_hardware.h"
+#include "check.h"
+
+using namespace SummerSpringBot;
+
+// the old serialInit() waited this long before anything else ran
+const unsigned long OLD_SERIAL_DELAY_MS = 2000;
+
+DifferentialDrive motors(11, 12, 10, 7, 8, 9);
+Sonar sonar(3, 4);
+IRSensor remote(2);
+
+// setup() as in MotorControlWithSensorsExample; returns when the motors took 
+// their first command, in us after reset
+static unsigned long boot(bool serialFirst) {
+  fakeCoreTiming = true;
+  fakeMicros = 0;
+  if (serialFirst) {
+    Serial.begin(9600);
+    delay(OLD_SERIAL_DELAY_MS);
+  }
+  motors.init();
+  motors.stop();
+  unsigned long motorsReady = micros();
+  sonar.init();
+  remote.init();
+  if (!serialFirst)
+    Serial.begin(9600);
+  fakeCoreTiming = false;
+  return motorsReady;
+}
+
+int main() {
+  fakeReset();
+  unsigned long blank = boot(false);
+  CHECK(blank < 500);
+
+  // with a stored config, init() reads it from EEPROM first
+  RobotConfig config;
+  motors.getConfig(config);
+  sonar.getConfig(config);
+  remote.getConfig(config);
+  saveRobotConfig(config);
+  unsigned long stored = boot(false);
+  CHECK(stored > blank);
+  CHECK(stored < 500);
+
+  fakeReset();
+  unsigned long old = boot(true);
+  CHECK(old > OLD_SERIAL_DELAY_MS * 1000);
+
+  printf("  first motor command %lu us after reset (%lu us with a stored config); "
+         "%lu us with serial brought up first\n", blank, stored, old);
+  return checkResult("test_boot");
+}
@@ -0,0 +1,139 @@
+// RobotConfig in EEPROM: what init() loads, and what it ignores (bad CRC, old 
+// version, nothing stored) in favour of the constructor values
+#include <stddef.h>
+#include <SSBotMotor.hpp>
+#include <SSBotSensor.hpp>
+#include "fake_hardware.h"
+#include "check.h"
+
+using namespace SummerSpringBot;
+
+// constructor values
+const uint8_t LEFT_MAX = 200, RIGHT_MAX = 180, SPEED = 40;
+const unsigned int CLEARANCE = 12;
+
+static RobotConfig stored() {
+  RobotConfig config;
+  config.leftMaxPWM = 100;
+  config.rightMaxPWM = 120;
+  config.defaultSpeed = 60;
+  config.clearanceThreshold = 25;
+  for (uint8_t i = 0; i < NUM_REMOTE_KEYS; i++)
+    config.keymap[i] = CMD_1 + i;
+  config.irAddress = 0x1234;
+  return config;
+}
+
+// bring everything up from whatever the EEPROM holds, and check which values won
+static void expectConstructorValues() {
+  DifferentialDrive motors(11, 12, 10, 7, 8, 9, LEFT_MAX, RIGHT_MAX, SPEED);
+  Sonar sonar(3, 4, CLEARANCE);
+  IRSensor remote(2);
+  motors.init();
+  sonar.init();
+  remote.init();
+
+  RobotConfig config;
+  motors.getConfig(config);
+  CHECK_EQ(config.leftMaxPWM, LEFT_MAX);
+  CHECK_EQ(config.rightMaxPWM, RIGHT_MAX);
+  CHECK_EQ(config.defaultSpeed, SPEED);
+  CHECK_EQ(sonar.clearanceThreshold, CLEARANCE);
+  CHECK_EQ(remote.key(KEY_FWD), FWD_BUTTON);
+  CHECK_EQ(remote.address(), IR_ANY_ADDRESS);
+  motors.fwd();
+  CHECK_EQ(fakeWheel(10, 11, 12), map(SPEED, 0, 100, 0, LEFT_MAX));
+}
+
+static void expectStoredValues() {
+  DifferentialDrive motors(11, 12, 10, 7, 8, 9, LEFT_MAX, RIGHT_MAX, SPEED);
+  Sonar sonar(3, 4, CLEARANCE);
+  IRSensor remote(2);
+  motors.init();
+  sonar.init();
+  remote.init();
+
+  RobotConfig config;
+  motors.getConfig(config);
+  CHECK_EQ(config.leftMaxPWM, 100);
+  CHECK_EQ(config.rightMaxPWM, 120);
+  CHECK_EQ(config.defaultSpeed, 60);
+  CHECK_EQ(sonar.clearanceThreshold, 25);
+  CHECK_EQ(remote.key(KEY_FWD), CMD_1);
+  CHECK_EQ(remote.key(KEY_ENABLE), CMD_1 + KEY_ENABLE);
+  CHECK_EQ(remote.address(), 0x1234);
+  motors.fwd();
+  CHECK_EQ(fakeWheel(10, 11, 12), map(60, 0, 100, 0, 100));
+  CHECK_EQ(fakeWheel(9, 7, 8), map(60, 0, 100, 0, 120));
+}
+
+static void testNothingStored() {
+  fakeReset();
+  RobotConfig config = stored();
+  CHECK(!loadRobotConfig(config));
+  CHECK_EQ(config.defaultSpeed, 60); // left untouched
+  expectConstructorValues();
+}
+
+static void testRoundTrip() {
+  fakeReset();
+  RobotConfig config = stored();
+  saveRobotConfig(config);
+  CHECK_EQ(config.version, ROBOT_CONFIG_VERSION);
+  RobotConfig loaded;
+  CHECK(loadRobotConfig(loaded));
+  CHECK_EQ(loaded.defaultSpeed, 60);
+  CHECK_EQ(loaded.irAddress, 0x1234);
+  expectStoredValues();
+
+  eraseRobotConfig();
+  CHECK(!loadRobotConfig(loaded));
+  expectConstructorValues();
+}
+
+static void testCRCMismatch() {
+  fakeReset();
+  RobotConfig config = stored();
+  saveRobotConfig(config);
+  fakeEEPROM[ROBOT_CONFIG_ADDRESS + offsetof(RobotConfig, defaultSpeed)] ^= 0x01;
+  RobotConfig loaded = stored();
+  loaded.defaultSpeed = 77;
+  CHECK(!loadRobotConfig(loaded));
+  CHECK_EQ(loaded.defaultSpeed, 77);
+  expectConstructorValues();
+}
+
+static void testVersionMismatch() {
+  // a config from an older layout, with a CRC that matches it
+  fakeReset();
+  RobotConfig config = stored();
+  config.version = ROBOT_CONFIG_VERSION - 1;
+  config.crc = crc8((const uint8_t*) &config, offsetof(RobotConfig, crc));
+  memcpy(fakeEEPROM + ROBOT_CONFIG_ADDRESS, &config, sizeof(config));
+  RobotConfig loaded;
+  CHECK(!loadRobotConfig(loaded));
+  expectConstructorValues();
+}
+
+static void testApplyLive() {
+  // a saved change can be applied without a restart
+  fakeReset();
+  DifferentialDrive motors(11, 12, 10, 7, 8, 9, LEFT_MAX, RIGHT_MAX, SPEED);
+  motors.init();
+  motors.fwd();
+  RobotConfig config = stored();
+  saveRobotConfig(config);
+  motors.applyConfig(config);
+  motors.stop();
+  motors.fwd();
+  CHECK_EQ(fakeWheel(10, 11, 12), map(60, 0, 100, 0, 100));
+}
+
+int main() {
+  testNothingStored();
+  testRoundTrip();
+  testCRCMismatch();
+  testVersionMismatch();
+  testApplyLive();
+  return checkResult("test_config");
+}
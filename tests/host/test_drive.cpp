@@ -0,0 +1,107 @@
+// DifferentialDrive: state and velocity reported for every kind of wheel command,
+// saturation that keeps the curve, and the per-call cost of each command
+#include <time.h>
+#include <SSBotMotor.hpp>
+#include "fake_hardware.h"
+#include "check.h"
+
+using namespace SummerSpringBot;
+
+DifferentialDrive motors(11, 12, 10, 7, 8, 9);
+
+static int leftPWM()  { return fakeWheel(10, 11, 12); }
+static int rightPWM() { return fakeWheel(9, 7, 8); }
+
+static void expect(int8_t left, int8_t right, DifferentialDrive::MotorState state, 
+                   int8_t velocity, int8_t angular) {
+  motors.driveWheels(left, right);
+  CHECK_EQ(motors.getState(), state);
+  CHECK_EQ(motors.getVelocity(), velocity);
+  CHECK_EQ(motors.getAngularVelocity(), angular);
+}
+
+static void testStates() {
+  expect(50, 50, DifferentialDrive::FWD, 50, 0);
+  expect(-30, -30, DifferentialDrive::REV, -30, 0);
+  expect(0, 0, DifferentialDrive::STOPPED, 0, 0);
+  expect(-40, 40, DifferentialDrive::TURN_LEFT, 40, 40);
+  expect(40, -40, DifferentialDrive::TURN_RIGHT, -40, -40);
+  // small differences and small speeds are never rounded away
+  expect(0, 1, DifferentialDrive::ARC_LEFT, 1, 1);
+  expect(1, 0, DifferentialDrive::ARC_RIGHT, 1, -1);
+  expect(50, 51, DifferentialDrive::ARC_LEFT, 51, 1);
+  expect(-50, -51, DifferentialDrive::ARC_RIGHT, -51, -1);
+  expect(-1, 2, DifferentialDrive::ARC_LEFT, 1, 2);
+}
+
+static void testMixing() {
+  motors.drive(60, 20);
+  CHECK_EQ(leftPWM(), map(40, 0, 100, 0, 255));
+  CHECK_EQ(rightPWM(), map(80, 0, 100, 0, 255));
+  CHECK_EQ(motors.getState(), DifferentialDrive::ARC_LEFT);
+
+  // 40/120 is too much for the right wheel: both scale down by the same ratio
+  motors.drive(80, 40);
+  CHECK_EQ(rightPWM(), 255);
+  CHECK_EQ(leftPWM(), map(33, 0, 100, 0, 255));
+
+  // tightest curvature pivots on the inside wheel
+  motors.curvatureDrive(60, 100);
+  CHECK_EQ(motors.getState(), DifferentialDrive::ARC_RIGHT);
+  CHECK_EQ(leftPWM(), map(100, 0, 100, 0, 255));
+  CHECK_EQ(rightPWM(), 0);
+  motors.curvatureDrive(60, 0);
+  CHECK_EQ(motors.getState(), DifferentialDrive::FWD);
+  CHECK_EQ(motors.getVelocity(), 60);
+
+  // setSpeed() keeps the curve
+  motors.drive(60, 20);
+  motors.setSpeed(30);
+  CHECK_EQ(motors.getState(), DifferentialDrive::ARC_LEFT);
+  CHECK_EQ(motors.getVelocity(), 30);
+  CHECK_EQ(motors.getAngularVelocity(), 10);
+
+  // a tight curve with a small linear speed: setSpeed(100) asks for wheels of 
+  // (400, -200), which must saturate to (100, -50) -- on AVR 400 * 100 overflows an int
+  motors.driveWheels(80, -40);
+  CHECK_EQ(motors.getVelocity(), 20);
+  motors.setSpeed(100);
+  CHECK_EQ(motors.getState(), DifferentialDrive::ARC_RIGHT);
+  CHECK_EQ(leftPWM(), 255);
+  CHECK_EQ(rightPWM(), -map(50, 0, 100, 0, 255));
+  CHECK_EQ(motors.getVelocity(), 25);
+  motors.setSpeed(10);
+  CHECK_EQ(motors.getState(), DifferentialDrive::ARC_RIGHT);
+  CHECK_EQ(motors.getVelocity(), 10);
+  motors.stop();
+}
+
+// CPU cost of one command, wheels included (host time, so only useful to compare)
+template <typename Command>
+static double nsPerCall(Command command) {
+  const long calls = 1000000;
+  clock_t start = clock();
+  for (long i = 0; i < calls; i++)
+    command((int8_t)(i & 63));
+  return (double)(clock() - start) * 1e9 / CLOCKS_PER_SEC / calls;
+}
+
+static void benchmark() {
+  double fwd = nsPerCall([](int8_t v) { motors.fwd(v + 1); });
+  double turn = nsPerCall([](int8_t v) { motors.turnLeft(v + 1); });
+  double mixed = nsPerCall([](int8_t v) { motors.drive(v, 20); });
+  double curve = nsPerCall([](int8_t v) { motors.curvatureDrive(v, 30); });
+  double wheels = nsPerCall([](int8_t v) { motors.driveWheels(v, v + 10); });
+  motors.stop();
+  printf("  ns per call on host: fwd() %.0f, turnLeft() %.0f, drive(v, w) %.0f, "
+         "curvatureDrive() %.0f, driveWheels() %.0f\n", fwd, turn, mixed, curve, wheels);
+}
+
+int main() {
+  fakeReset();
+  motors.init();
+  testStates();
+  testMixing();
+  benchmark();
+  return checkResult("test_drive");
+}
@@ -0,0 +1,230 @@
+// SpeedGovernor: simulated approaches to fixed and moving obstacles, 
+// re-commanding the robot after a stop, and slowing down on curves
+#include <SSBotGovernor.hpp>
+#include "fake_hardware.h"
+#include "check.h"
+
+using namespace SummerSpringBot;
+
+const unsigned int TOP_SPEED = 100;  // cm/s at drive(100)
+const unsigned int BRAKING = 200;    // cm/s^2
+const unsigned int CLEARANCE = 10;   // cm
+
+DifferentialDrive motors(11, 12, 10, 7, 8, 9);
+
+struct Approach {
+  float minGap;     // closest the robot got to the obstacle, cm
+  float finalSpeed; // cm/s
+};
+
+// Drive at `command` towards an obstacle `start` cm away that moves at `obstacleSpeed` 
+// cm/s (negative = towards the robot) for the first 3 s. The robot's real speed 
+// follows the commanded one, but can only slow down at BRAKING.
+static Approach approach(int8_t command, float start, float obstacleSpeed, 
+                         unsigned int topSpeed = TOP_SPEED, unsigned int braking = BRAKING,
+                         bool rangeGating = false) {
+  fakeReset();
+  Sonar sonar(3, 4, CLEARANCE);
+  motors.init();
+  sonar.init();
+  sonar.setRangeGating(rangeGating);
+  SpeedGovernor governor(motors, sonar, topSpeed, braking);
+  motors.fwd(command);
+
+  float position = 0, speed = 0, obstacle = start;
+  Approach result = {start, 0};
+  unsigned long startMicros = fakeMicros;
+  while (fakeMicros - startMicros < 10000000UL) {
+    float gap = obstacle - position;
+    fakeSonarDistance = (gap > 400) ? 0 : (gap < 1 ? 1 : (unsigned int) gap);
+    unsigned long before = fakeMicros;
+    governor.update();
+    if (fakeMicros == before)
+      fakeMicros += 1000; // the rest of loop()
+    float dt = (fakeMicros - before) / 1e6;
+
+    float target = motors.getVelocity() * (float) topSpeed / 100;
+    float dv = target - speed;
+    if (dv < -(float) braking * dt) dv = -(float) braking * dt;
+    if (dv > 2.0f * braking * dt) dv = 2.0f * braking * dt;
+    speed += dv;
+    position += speed * dt;
+    if (fakeMicros - startMicros < 3000000UL)
+      obstacle += obstacleSpeed * dt;
+    if (obstacle - position < result.minGap)
+      result.minGap = obstacle - position;
+  }
+  result.finalSpeed = speed;
+  return result;
+}
+
+static void testFixedObstacles() {
+  Approach fast = approach(100, 300, 0);
+  CHECK(fast.minGap >= CLEARANCE - 1);
+  CHECK(fast.finalSpeed == 0);
+
+  Approach slow = approach(50, 300, 0);
+  CHECK(slow.minGap >= CLEARANCE - 1);
+  CHECK(slow.finalSpeed == 0);
+
+  Approach close = approach(100, 60, 0);
+  CHECK(close.minGap >= CLEARANCE - 1);
+  CHECK(close.finalSpeed == 0);
+}
+
+static void testMovingObstacle() {
+  // an obstacle coming at 30 cm/s eats into the clearance, but is never hit
+  Approach oncoming = approach(80, 300, -30);
+  CHECK(oncoming.minGap > 0);
+  CHECK(oncoming.finalSpeed == 0);
+}
+
+static void testRangeGating() {
+  // the gate has to reach past the stopping distance, which depends on the robot:
+  // 300 cm/s with weak brakes needs ~470 cm, far more than the default robot
+  Approach gated = approach(100, 300, 0, TOP_SPEED, BRAKING, true);
+  CHECK(gated.minGap >= CLEARANCE - 1);
+  CHECK(gated.finalSpeed == 0);
+
+  Approach fast = approach(100, 450, 0, 300, 100, true);
+  CHECK(fast.minGap >= CLEARANCE - 1);
+  CHECK(fast.finalSpeed == 0);
+
+  // without gating, 5-ping medians out to 500 cm take longer than the 60 ms reaction 
+  // time assumed, so the robot eats a little into the clearance -- but never hits
+  Approach fastUngated = approach(100, 450, 0, 300, 100, false);
+  CHECK(fastUngated.minGap > 0);
+}
+
+static void settle(SpeedGovernor& governor, int ms) {
+  for (int i = 0; i < ms; i++) {
+    governor.update();
+    fakeAdvanceMillis(1);
+  }
+}
+
+static void testOpenSpace() {
+  fakeReset();
+  Sonar sonar(3, 4, CLEARANCE);
+  SpeedGovernor governor(motors, sonar);
+  motors.init();
+  motors.fwd(80);
+  for (int i = 0; i < 200; i++) {
+    governor.update();
+    fakeAdvanceMillis(1);
+  }
+  CHECK_EQ(governor.speedLimit(), 100);
+  CHECK_EQ(motors.getVelocity(), 80);
+}
+
+static void testRecommandAfterStop() {
+  fakeReset();
+  Sonar sonar(3, 4, CLEARANCE);
+  SpeedGovernor governor(motors, sonar);
+  motors.init();
+  fakeSonarDistance = 200;
+
+  motors.fwd(50);
+  for (int i = 0; i < 100; i++) {
+    governor.update();
+    fakeAdvanceMillis(1);
+  }
+  CHECK_EQ(motors.getVelocity(), 50);
+
+  // stop, then ask for the same speed the governor was holding
+  motors.stop();
+  governor.update();
+  motors.fwd(50);
+  for (int i = 0; i < 100; i++) {
+    governor.update();
+    fakeAdvanceMillis(1);
+  }
+  CHECK_EQ(motors.getState(), DifferentialDrive::FWD);
+  CHECK_EQ(motors.getVelocity(), 50);
+}
+
+
+static void testCurves() {
+  fakeReset();
+  Sonar sonar(3, 4, CLEARANCE);
+  SpeedGovernor governor(motors, sonar);
+  motors.init();
+
+  // an arc is slowed down like fwd(), keeping its shape
+  fakeSonarDistance = 20;
+  motors.drive(60, 20);
+  settle(governor, 300);
+  int8_t limited = motors.getVelocity();
+  CHECK(limited > 0 && limited < 60);
+  CHECK_EQ(motors.getState(), DifferentialDrive::ARC_LEFT);
+  CHECK_EQ(motors.getAngularVelocity(), 20 * limited / 60);
+
+  // held at 0 right at the clearance, then back to the same curve once it clears
+  fakeSonarDistance = CLEARANCE;
+  settle(governor, 300);
+  CHECK_EQ(motors.getVelocity(), 0);
+  fakeSonarDistance = 0;
+  settle(governor, 300);
+  CHECK_EQ(motors.getState(), DifferentialDrive::ARC_LEFT);
+  CHECK_EQ(motors.getVelocity(), 60);
+  CHECK_EQ(motors.getAngularVelocity(), 20);
+
+  fakeSonarDistance = 20;
+  motors.curvatureDrive(80, 50);
+  settle(governor, 300);
+  CHECK(motors.getVelocity() > 0 && motors.getVelocity() < 80);
+  CHECK_EQ(motors.getState(), DifferentialDrive::ARC_RIGHT);
+
+  // steering along a line sends new wheel speeds every loop
+  fakeSonarDistance = 20;
+  for (int i = 0; i < 300; i++) {
+    motors.driveWheels(70, 70 + (i % 10));
+    governor.update();
+    fakeAdvanceMillis(1);
+  }
+  CHECK(motors.getVelocity() > 0 && motors.getVelocity() < 70);
+  CHECK_EQ(governor.speedLimit(), limited);
+
+  // spinning on the spot or backing away isn't limited
+  motors.turnLeft(50);
+  settle(governor, 300);
+  CHECK_EQ(motors.getVelocity(), 50);
+  motors.drive(-60, 20);
+  settle(governor, 300);
+  CHECK_EQ(motors.getVelocity(), -60);
+  motors.stop();
+}
+
+static void testSlowerCommandWhileGoverned() {
+  fakeReset();
+  Sonar sonar(3, 4, CLEARANCE);
+  SpeedGovernor governor(motors, sonar);
+  motors.init();
+
+  fakeSonarDistance = 16;
+  motors.fwd(80);
+  settle(governor, 300);
+  int8_t governed = motors.getVelocity();
+  CHECK(governed > 0 && governed < 80);
+
+  // the user asks for exactly the speed the governor is holding: once the way 
+  // clears, that's the speed to go back to, not the 80 asked for before
+  motors.fwd(governed);
+  settle(governor, 10);
+  fakeSonarDistance = 0;
+  settle(governor, 300);
+  CHECK_EQ(governor.speedLimit(), 100);
+  CHECK_EQ(motors.getVelocity(), governed);
+  motors.stop();
+}
+
+int main() {
+  testFixedObstacles();
+  testMovingObstacle();
+  testRangeGating();
+  testOpenSpace();
+  testRecommandAfterStop();
+  testCurves();
+  testSlowerCommandWhileGoverned();
+  return checkResult("test_governor");
+}
@@ -0,0 +1,135 @@
+// IRSensor: address filtering with several remotes sending at once, how many 
+// frames a crowded room costs us at the 20 ms polling period, and pairing
+#include <SSBotSensor.hpp>
+#include "fake_hardware.h"
+#include "check.h"
+
+using namespace SummerSpringBot;
+
+const uint16_t NEC_CH = 70;    // raw NEC command of the CH button
+const int FRAME_GAP_MS = 21;   // just over IRSensor's 20ms polling period
+const unsigned long NEC_FRAME_US = 108000; // a held NEC remote sends a frame this often
+
+// poll like loop() does until every queued frame has been decoded
+static int countCommands(IRSensor& remote) {
+  int received = 0;
+  while (fakeQueuedIR() > 0) {
+    if (remote.query() != NONE)
+      received++;
+    fakeAdvanceMillis(FRAME_GAP_MS);
+  }
+  return received;
+}
+
+static void testInterleavedRemotes() {
+  fakeReset();
+  IRSensor remote(2);
+  remote.init();
+  remote.setAddress(0x20);
+  // 4 remotes taking turns, plus a repeat frame from ours that must not count
+  const uint16_t addresses[] = {0x00, 0x20, 0x40, 0x60};
+  for (int i = 0; i < 200; i++)
+    fakeQueueIR(addresses[i % 4], NEC_CH);
+  fakeQueueIR(0x20, NEC_CH, IRDATA_FLAGS_IS_REPEAT);
+  CHECK_EQ(countCommands(remote), 50);
+
+  // listening to everyone, every non-repeat frame counts
+  fakeReset();
+  remote.setAddress(IR_ANY_ADDRESS);
+  for (int i = 0; i < 40; i++)
+    fakeQueueIR(addresses[i % 4], NEC_CH);
+  CHECK_EQ(countCommands(remote), 40);
+}
+
+struct Traffic {
+  float acceptedPerSecond; // our remote's frames that got through
+  float dropsPerAccepted;  // frames (any remote) lost because the receiver was full
+};
+
+// `remotes` remotes (ours is 0x20) each send a frame every NEC_FRAME_US, evenly 
+// staggered, for 2 s; loop() polls query() every ms
+static Traffic crowdedRoom(int remotes) {
+  fakeReset();
+  IRSensor remote(2);
+  remote.init();
+  remote.setAddress(0x20);
+  const unsigned long duration = 2000000;
+  unsigned long start = fakeMicros;
+  for (unsigned long t = 0; t < duration; t += NEC_FRAME_US)
+    for (int r = 0; r < remotes; r++)
+      fakeQueueIRAt(start + t + r * NEC_FRAME_US / remotes + 1, 0x20 + 0x10 * r, NEC_CH);
+
+  int accepted = 0;
+  while (fakeMicros - start < duration + NEC_FRAME_US) {
+    if (remote.query() != NONE)
+      accepted++;
+    fakeAdvanceMillis(1);
+  }
+  Traffic result = {accepted * 1e6f / duration, accepted ? (float) fakeIRDropped / accepted : 0};
+  return result;
+}
+
+static void benchmarkCrowdedRoom() {
+  // frames 27 ms apart: the 20 ms polling period catches every one
+  Traffic four = crowdedRoom(4);
+  CHECK(four.acceptedPerSecond == 19 / 2.0f); // all 19 our remote sent in 2 s
+  CHECK(four.dropsPerAccepted == 0);
+  // frames 13.5 ms apart come faster than we look, and some of ours are lost
+  Traffic eight = crowdedRoom(8);
+  CHECK(eight.dropsPerAccepted > 0);
+  CHECK(eight.acceptedPerSecond < four.acceptedPerSecond);
+  printf("  our remote's frames accepted: %.1f/s with 4 remotes in the room (%.2f drops "
+         "per accepted frame), %.1f/s with 8 (%.2f drops per accepted frame)\n", 
+         four.acceptedPerSecond, four.dropsPerAccepted, 
+         eight.acceptedPerSecond, eight.dropsPerAccepted);
+}
+
+static void testPairing() {
+  fakeReset();
+  IRSensor remote(2);
+  remote.init();
+  remote.pair();
+  CHECK(remote.isPairing());
+  fakeQueueIR(0x40, NEC_CH, IRDATA_FLAGS_IS_REPEAT); // repeats don't pair
+  fakeQueueIR(0x40, NEC_CH);
+  fakeQueueIR(0x60, NEC_CH);
+  CHECK_EQ(countCommands(remote), 1);
+  CHECK_EQ(remote.address(), 0x40);
+  CHECK(!remote.isPairing());
+
+  // re-pairing moves to a different remote, even with an address already set
+  remote.setAddress(0x10);
+  remote.pair();
+  fakeQueueIR(0x60, NEC_CH);
+  fakeQueueIR(0x10, NEC_CH);
+  CHECK_EQ(countCommands(remote), 1);
+  CHECK_EQ(remote.address(), 0x60);
+}
+
+static void testStoredAddress() {
+  fakeReset();
+  RobotConfig config;
+  IRSensor configured(2);
+  configured.getConfig(config);
+  config.leftMaxPWM = config.rightMaxPWM = 255;
+  config.defaultSpeed = 50;
+  config.clearanceThreshold = 10;
+  config.irAddress = 0x20;
+  saveRobotConfig(config);
+
+  IRSensor remote(2);
+  remote.init();
+  CHECK_EQ(remote.address(), 0x20);
+  remote.pair();
+  fakeQueueIR(0x40, NEC_CH);
+  CHECK_EQ(countCommands(remote), 1);
+  CHECK_EQ(remote.address(), 0x40);
+}
+
+int main() {
+  testInterleavedRemotes();
+  benchmarkCrowdedRoom();
+  testPairing();
+  testStoredAddress();
+  return checkResult("test_ir");
+}
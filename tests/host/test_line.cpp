@@ -0,0 +1,146 @@
+// LineSensorArray: line position and steering, plus how often the background 
+// sampler refreshes the sensors and how soon readLine() sees the line move
+#include <SSBotLine.hpp>
+#include <time.h>
+#include "fake_hardware.h"
+#include "check.h"
+
+using namespace SummerSpringBot;
+
+const int NUM_SENSORS = 5;
+const uint8_t pins[NUM_SENSORS] = {A0, A1, A2, A3, A4};
+const unsigned long ADC_CONVERSION_US = 104; // 13 ADC clocks at 125 kHz
+const uint16_t FLOOR = 100, LINE = 900;      // raw readings
+
+DifferentialDrive motors(11, 12, 10, 7, 8, 9);
+LineSensorArray line(pins, NUM_SENSORS);
+
+static uint16_t surface[NUM_SENSORS];        // what each sensor sees right now
+static unsigned long nextConversion;
+
+// finish every conversion due by now, one per ADC_CONVERSION_US like the real ADC
+static void runADC() {
+  while (fakeMicros >= nextConversion) {
+    fakeADCConvert(surface[ADMUX & 0x0F]);
+    nextConversion += ADC_CONVERSION_US;
+  }
+}
+
+static void waitMicros(unsigned long us) {
+  fakeMicros += us;
+  runADC();
+}
+
+// a line 1 sensor wide, centred at `position` (0 = under the leftmost sensor)
+static void putLineAt(float position) {
+  for (int i = 0; i < NUM_SENSORS; i++) {
+    float d = i - position;
+    if (d < 0) d = -d;
+    surface[i] = (d >= 1) ? FLOOR : LINE - (uint16_t)(d * (LINE - FLOOR));
+  }
+}
+
+static void removeLine() {
+  for (int i = 0; i < NUM_SENSORS; i++)
+    surface[i] = FLOOR;
+}
+
+static void testCalibrateRightAfterInit() {
+  // like LineFollowerExample: calibrate() straight after init(), before the 
+  // sampler has been round the sensors once
+  removeLine();
+  line.calibrate();
+  waitMicros(2000);
+  line.calibrate();
+  for (int i = 0; i < NUM_SENSORS; i++)
+    surface[i] = LINE;
+  waitMicros(2000);
+  line.calibrate();
+
+  putLineAt(0);
+  waitMicros(2000);
+  CHECK(line.readLine() < 50);
+}
+
+static void testPositionAndSteering() {
+  removeLine();
+  waitMicros(2000);
+  line.calibrate();
+  for (int i = 0; i < NUM_SENSORS; i++)
+    surface[i] = LINE;
+  waitMicros(2000);
+  line.calibrate();
+
+  putLineAt(2);
+  waitMicros(2000);
+  CHECK_EQ(line.readLine(), 2000);
+  CHECK_EQ(line.lineError(), 0);
+  CHECK(line.lineDetected());
+
+  putLineAt(2.5);
+  waitMicros(2000);
+  CHECK_EQ(line.readLine(), 2500);
+
+  putLineAt(0.5);
+  waitMicros(2000);
+  uint16_t left = line.readLine();
+  CHECK(left > 400 && left < 600);
+  CHECK(line.lineError() < 0);
+  line.steer(motors, 60, 50);
+  // line to the left: the left wheel slows down
+  int leftWheel = fakeWheel(10, 11, 12), rightWheel = fakeWheel(9, 7, 8);
+  CHECK(leftWheel < rightWheel);
+  CHECK(leftWheel > 0);
+
+  // lost off the left edge: remembers that side
+  removeLine();
+  waitMicros(2000);
+  CHECK_EQ(line.readLine(), 0);
+  CHECK(!line.lineDetected());
+}
+
+static void benchmarkUpdateRate() {
+  // sensor refresh rate: the ADC runs on its own, whatever loop() is doing
+  uint16_t sweepsBefore = AnalogSampler::sweeps();
+  waitMicros(1000000);
+  unsigned int sweepsPerSecond = (uint16_t)(AnalogSampler::sweeps() - sweepsBefore);
+  CHECK(sweepsPerSecond >= 1000000 / (ADC_CONVERSION_US * NUM_SENSORS) - 1);
+
+  // latency: move the line from sensor 1 to sensor 3 while loop() polls every 50 us, 
+  // and time how long until readLine() says it's past the middle
+  putLineAt(1);
+  waitMicros(2000);
+  line.readLine();
+  putLineAt(3);
+  unsigned long moved = fakeMicros, latency = 0;
+  for (int i = 0; i < 1000 && latency == 0; i++) {
+    waitMicros(50);
+    if (line.readLine() > 2500)
+      latency = fakeMicros - moved;
+  }
+  CHECK(latency > 0);
+  CHECK(latency <= 2 * ADC_CONVERSION_US * NUM_SENSORS);
+
+  // CPU cost of readLine() itself (host time, so only useful to compare changes)
+  const long calls = 1000000;
+  volatile uint16_t sink = 0;
+  clock_t start = clock();
+  for (long i = 0; i < calls; i++)
+    sink += line.readLine();
+  double nsPerCall = (double)(clock() - start) * 1e9 / CLOCKS_PER_SEC / calls;
+
+  printf("  %u sweeps/s of %d sensors, line move seen after %lu us; "
+         "blocking analogRead() would stall loop() %lu us per read; readLine() %.0f ns on host\n",
+         sweepsPerSecond, NUM_SENSORS, latency, NUM_SENSORS * 112UL, nsPerCall);
+}
+
+int main() {
+  fakeReset();
+  nextConversion = fakeMicros;
+  motors.init();
+  CHECK(line.init());
+  testCalibrateRightAfterInit();
+  testPositionAndSteering();
+  benchmarkUpdateRate();
+  return checkResult("test_line");
+}
@@ -0,0 +1,119 @@
+// Timer1 PWM: the registers useTimerPWM() sets up and the compare values each 
+// speed writes, read back from the fake Timer1
+#include <SSBotMotor.hpp>
+#include "fake_hardware.h"
+#include "check.h"
+
+using namespace SummerSpringBot;
+
+const uint8_t FAST_PWM_ICR1_A = _BV(WGM11);              // mode 14, low half
+const uint8_t FAST_PWM_ICR1_B = _BV(WGM13) | _BV(WGM12); // mode 14, high half
+const uint8_t CLOCK_SELECT = _BV(CS12) | _BV(CS11) | _BV(CS10);
+
+static void test20kHz8Bit() {
+  fakeReset();
+  Motor motor(4, 5, 10);
+  motor.init(false);
+  CHECK((motor.useTimerPWM<10, 20000>()));
+  CHECK_EQ(ICR1, 799);                                    // 16 MHz / 20 kHz - 1
+  CHECK_EQ(TCCR1B & CLOCK_SELECT, 1);                     // no prescaler
+  CHECK_EQ(TCCR1B & ~CLOCK_SELECT, FAST_PWM_ICR1_B);
+  CHECK_EQ(TCCR1A & (_BV(WGM11) | _BV(WGM10)), FAST_PWM_ICR1_A);
+
+  motor.drive(50);
+  CHECK_EQ(OCR1B, 127UL * 800 / 256);                     // 127 of 255, scaled to TOP
+  CHECK(TCCR1A & _BV(COM1B1));
+  CHECK(!(TCCR1A & _BV(COM1A1)));                         // the other pin is left alone
+  motor.drive(100);
+  CHECK_EQ(OCR1B, 255UL * 800 / 256);
+
+  // at 0 the pin is disconnected from the timer and held low
+  motor.drive(0);
+  CHECK(!(TCCR1A & _BV(COM1B1)));
+  CHECK_EQ(fakeDigital[10], LOW);
+  CHECK_EQ(TCCR1B & CLOCK_SELECT, 1);                     // timer keeps running
+}
+
+static void test15kHz10Bit() {
+  fakeReset();
+  Motor motor(4, 5, 9);
+  motor.init(false);
+  CHECK((motor.useTimerPWM<9, 15000, 10>()));
+  CHECK_EQ(ICR1, 1065);                                   // 16 MHz / 15 kHz - 1
+  CHECK_EQ(TCCR1B & CLOCK_SELECT, 1);
+
+  motor.drive(50);
+  CHECK_EQ(OCR1A, 511UL * 1066 / 1024);                   // 511 of 1023, scaled to TOP
+  CHECK(TCCR1A & _BV(COM1A1));
+  motor.stop();
+  CHECK(!(TCCR1A & _BV(COM1A1)));
+}
+
+static void testPrescaler() {
+  // 100 Hz needs more than 16 bits of TOP at full clock: /8 gives 19999
+  fakeReset();
+  Motor motor(4, 5, 10);
+  motor.init(false);
+  CHECK((motor.useTimerPWM<10, 100>()));
+  CHECK_EQ(ICR1, 19999);
+  CHECK_EQ(TCCR1B & CLOCK_SELECT, _BV(CS11));             // clk/8
+}
+
+static void testMaxPWM() {
+  // maxPWM keeps meaning "out of 255" at 10 bits
+  fakeReset();
+  Motor motor(4, 5, 10, 128);
+  motor.init(false);
+  CHECK((motor.useTimerPWM<10, 15000, 10>()));
+  motor.drive(100);
+  CHECK_EQ(OCR1B, 514UL * 1066 / 1024);                   // 128/255 of 1023
+}
+
+static void testWrongPins() {
+  // a pin that isn't this motor's PWM pin: nothing is touched
+  fakeReset();
+  Motor motor(4, 5, 10);
+  motor.init(false);
+  CHECK(!(motor.useTimerPWM<9, 20000>()));
+  CHECK_EQ(TCCR1B, 0);
+  CHECK_EQ(ICR1, 0);
+  motor.drive(50);
+  CHECK_EQ(fakePWM[10], 127);                             // still analogWrite()
+
+  // swapped left/right pins, and one wheel not on Timer1 at all
+  fakeReset();
+  DifferentialDrive swapped(11, 12, 10, 7, 8, 9);
+  swapped.init();
+  CHECK(!(swapped.useTimerPWM<9, 10, 20000>()));
+  CHECK_EQ(TCCR1B, 0);
+  CHECK_EQ(ICR1, 0);
+
+  fakeReset();
+  DifferentialDrive oneWheel(11, 12, 3, 7, 8, 10);
+  oneWheel.init();
+  CHECK(!(oneWheel.useTimerPWM<9, 10, 20000>()));
+  CHECK_EQ(TCCR1B, 0);
+  oneWheel.fwd(50);
+  CHECK_EQ(fakePWM[3], 127);
+  CHECK_EQ(fakePWM[10], 127);
+
+  // the right order works, and both wheels share the timer
+  fakeReset();
+  DifferentialDrive drive(11, 12, 10, 7, 8, 9);
+  drive.init();
+  CHECK((drive.useTimerPWM<10, 9, 20000>()));
+  drive.fwd(50);
+  CHECK_EQ(OCR1A, 127UL * 800 / 256);
+  CHECK_EQ(OCR1B, 127UL * 800 / 256);
+  CHECK(TCCR1A & _BV(COM1A1));
+  CHECK(TCCR1A & _BV(COM1B1));
+}
+
+int main() {
+  test20kHz8Bit();
+  test15kHz10Bit();
+  testPrescaler();
+  testMaxPWM();
+  testWrongPins();
+  return checkResult("test_pwm");
+}
@@ -0,0 +1,133 @@
+// MotionScript: step timing, loops, and uploads that don't fit or jump out of bounds
+#include <SSBotScript.hpp>
+#include "fake_hardware.h"
+#include "check.h"
+
+using namespace SummerSpringBot;
+
+DifferentialDrive motors(11, 12, 10, 7, 8, 9);
+Sonar sonar(3, 4);
+MotionScript script(motors, sonar);
+
+// run the script on the fake clock, 1 ms per tick; returns how long it took
+static unsigned long runToEnd(unsigned long limitMs = 60000) {
+  unsigned long start = millis();
+  while (script.isRunning() && millis() - start < limitMs) {
+    script.tick();
+    fakeAdvanceMillis(1);
+  }
+  return millis() - start;
+}
+
+static void uploadBytes(const uint8_t* bytes, int n, bool* done) {
+  for (int i = 0; i < n; i++)
+    *done = script.receive(bytes[i]);
+}
+
+static void testSquareThenApproach() {
+  const MotionStep steps[] = {
+    MOTION_DRIVE(60, 1500), MOTION_TURN_LEFT(50, 400), MOTION_LOOP(0, 2),
+    MOTION_DRIVE(40, 0), MOTION_WAIT_SONAR(20), MOTION_STOP(0), MOTION_END()
+  };
+  fakeSonarDistance = 100;
+  script.run(steps, false);
+  CHECK_EQ(motors.getState(), DifferentialDrive::FWD);
+  CHECK_EQ(motors.getVelocity(), 60);
+  fakeAdvanceMillis(1500);
+  script.tick();
+  CHECK_EQ(motors.getState(), DifferentialDrive::TURN_LEFT);
+  fakeAdvanceMillis(400);
+  script.tick(); // LOOP back to step 0
+  CHECK_EQ(script.currentStep(), 0);
+  fakeAdvanceMillis(1500);
+  script.tick();
+  fakeAdvanceMillis(400);
+  script.tick(); // second time through the LOOP carries on to step 3
+  CHECK_EQ(script.currentStep(), 3);
+  script.tick();
+  CHECK_EQ(script.currentStep(), 4);
+  CHECK_EQ(motors.getVelocity(), 40);
+  fakeSonarDistance = 15;
+  fakeAdvanceMillis(100);
+  script.tick(); // on to STOP(0)...
+  script.tick(); // ...and END
+  CHECK(!script.isRunning());
+  CHECK_EQ(motors.getState(), DifferentialDrive::STOPPED);
+}
+
+static void testLongLoopCount() {
+  // 300 passes is more than a uint8_t counter can hold
+  const MotionStep steps[] = { MOTION_DRIVE(50, 10), MOTION_LOOP(0, 300), MOTION_END() };
+  script.run(steps, false);
+  unsigned long took = runToEnd();
+  CHECK(!script.isRunning());
+  CHECK(took >= 300 * 10 && took < 300 * 12);
+}
+
+static void testLoopOutOfBounds() {
+  const MotionStep forward[] = { MOTION_DRIVE(50, 10), MOTION_LOOP(5, 0), MOTION_END() };
+  script.run(forward, false);
+  runToEnd(1000);
+  CHECK(!script.isRunning());
+  CHECK_EQ(motors.getState(), DifferentialDrive::STOPPED);
+
+  const MotionStep negative[] = { MOTION_DRIVE(50, 10), MOTION_LOOP(-3, 0), MOTION_END() };
+  script.run(negative, false);
+  runToEnd(1000);
+  CHECK(!script.isRunning());
+}
+
+static void testUploadFillsBufferOfManySteps() {
+  // more than 64 steps: a byte counter would wrap at 256 bytes
+  static MotionStep buffer[100];
+  bool done = false;
+  CHECK(script.beginUpload(buffer, 100));
+  for (int i = 0; i < 100 && !done; i++) {
+    const uint8_t step[] = { OP_DRIVE, (uint8_t) (i % 100), 1, 0 };
+    uploadBytes(step, 4, &done);
+  }
+  CHECK(done);
+  CHECK_EQ(buffer[0].op, OP_DRIVE);
+  CHECK_EQ(buffer[0].arg, 0);
+  CHECK_EQ(buffer[64].op, OP_DRIVE);
+  CHECK_EQ(buffer[64].arg, 64);
+  CHECK_EQ(buffer[99].op, OP_END);
+  // further bytes go nowhere
+  CHECK(!script.receive(0xAA));
+  CHECK_EQ(buffer[0].op, OP_DRIVE);
+}
+
+static void testUploadRejectsBadInput() {
+  MotionStep buffer[4];
+  CHECK(!script.beginUpload(buffer, 0));
+  CHECK(!script.receive(OP_DRIVE));
+
+  bool done = false;
+  CHECK(script.beginUpload(buffer, 4));
+  const uint8_t bytes[] = { OP_DRIVE, 50, 10, 0,   OP_LOOP, 7, 0, 0 }; // loop past the end
+  uploadBytes(bytes, sizeof(bytes), &done);
+  CHECK(done);
+  CHECK_EQ(buffer[1].op, OP_END);
+
+  done = false;
+  CHECK(script.beginUpload(buffer, 4));
+  const uint8_t good[] = { OP_DRIVE, 50, 10, 0,   OP_LOOP, 0, 3, 0,   OP_END, 0, 0, 0 };
+  uploadBytes(good, sizeof(good), &done);
+  CHECK(done);
+  CHECK_EQ(buffer[1].op, OP_LOOP);
+  script.run(buffer, false);
+  unsigned long took = runToEnd();
+  CHECK(took >= 30 && took < 36);
+}
+
+int main() {
+  fakeReset();
+  motors.init();
+  sonar.init();
+  testSquareThenApproach();
+  testLongLoopCount();
+  testLoopOutOfBounds();
+  testUploadFillsBufferOfManySteps();
+  testUploadRejectsBadInput();
+  return checkResult("test_script");
+}
@@ -0,0 +1,73 @@
+// Sonar: range gate size and reading rate with and without gating
+#include <SSBotSensor.hpp>
+#include "fake_hardware.h"
+#include "check.h"
+
+using namespace SummerSpringBot;
+
+// readings per second, and ms loop() is blocked per reading, over 10 s of fake time
+static void readingRate(bool gated, unsigned int obstacle, float* perSecond, float* blockedMs) {
+  fakeReset();
+  Sonar sonar(3, 4);
+  sonar.init();
+  sonar.setRangeGating(gated);
+  sonar.setLookahead(40);
+  fakeSonarDistance = obstacle;
+  unsigned long blocked = 0, readings = 0, lastRead = 0;
+  unsigned long start = fakeMicros;
+  while (fakeMicros - start < 10000000UL) {
+    unsigned long before = fakeMicros;
+    sonar.read();
+    blocked += fakeMicros - before;
+    if (sonar.readTime() != lastRead) {
+      readings++;
+      lastRead = sonar.readTime();
+    }
+    fakeMicros += 100;
+  }
+  *perSecond = readings / 10.0f;
+  *blockedMs = blocked / 1000.0f / readings;
+}
+
+static void testGateFollowsLookahead() {
+  fakeReset();
+  Sonar sonar(3, 4, 10);
+  sonar.setRangeGating(true);
+  sonar.setLookahead(150);
+  sonar.read();
+  CHECK_EQ(fakeSonarLastMax, 10 + 10 + 150);
+  // every 8th gated ping looks out to full range
+  for (int i = 1; i < 8; i++) {
+    fakeAdvanceMillis(30);
+    sonar.read();
+  }
+  CHECK_EQ(fakeSonarLastMax, MAX_SENSOR_DISTANCE);
+  sonar.setLookahead(60000);
+  fakeAdvanceMillis(30);
+  sonar.read();
+  CHECK_EQ(fakeSonarLastMax, MAX_SENSOR_DISTANCE);
+}
+
+static void testGatedReadings() {
+  float plainRate, plainBlocked, gatedRate, gatedBlocked;
+  readingRate(false, 0, &plainRate, &plainBlocked);
+  readingRate(true, 0, &gatedRate, &gatedBlocked);
+  printf("  open space: %.1f readings/s, %.1f ms each ungated; %.1f readings/s, %.1f ms each gated\n",
+         plainRate, plainBlocked, gatedRate, gatedBlocked);
+  CHECK(gatedRate > 3 * plainRate);
+  CHECK(gatedBlocked * 4 < plainBlocked);
+
+  // an obstacle inside the gate is still reported
+  fakeReset();
+  Sonar sonar(3, 4, 10);
+  sonar.setRangeGating(true);
+  fakeSonarDistance = 8;
+  CHECK_EQ(sonar.read(), 8);
+  CHECK(!sonar.clearAhead());
+}
+
+int main() {
+  testGateFollowsLookahead();
+  testGatedReadings();
+  return checkResult("test_sonar");
+}
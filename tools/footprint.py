@@ -0,0 +1,205 @@
+#!/usr/bin/env python3
+"""
+footprint.py - Flash, RAM and stack use of the SSBot libraries, checked against budgets.
+
+Three reports:
+  * examples: compiles each example with arduino-cli and compares "Sketch uses N
+    bytes" and "Global variables use M bytes" to tools/footprint_budget.json ("free"
+    is the RAM left for stack and heap). An example with no budget there is listed
+    but not checked: run --update once on a known-good build to record a baseline.
+  * classes: compiles tools/footprint_probe and reads sizeof() of every library class
+    off its symbol table (avr-nm), next to the budgets in SSBotFootprint.hpp.
+  * stack: with --port, uploads the probe, which runs every class's per-loop work
+    and logs stackUnused(); reports the high-water mark (least stack never used).
+Exits non-zero if anything is over a recorded budget.
+
+Usage:
+    python3 tools/footprint.py                 # check examples and class sizes
+    python3 tools/footprint.py --update        # record current sizes (+ headroom) as budgets
+    python3 tools/footprint.py --port /dev/ttyACM0   # also measure stack on the robot
+    python3 tools/footprint.py --fqbn arduino:avr:nano
+"""
+
+import argparse
+import glob
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+import ssbot_log
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+BUDGET_FILE = os.path.join(ROOT, "tools", "footprint_budget.json")
+FOOTPRINT_HEADER = os.path.join(ROOT, "SSBotMotor", "src", "SSBotFootprint.hpp")
+PROBE = os.path.join(ROOT, "tools", "footprint_probe")
+HEADROOM = 1.05       # --update leaves 5% room to grow
+STACK_MARGIN = 128    # fail if the stack ever came closer than this to the heap
+STACK_SECONDS = 5     # how long to watch the probe run
+
+
+def examples():
+    return sorted(glob.glob(os.path.join(ROOT, "*", "examples", "*", "*.ino")))
+
+
+def compile_sketch(sketch_dir, fqbn, build_path=None):
+    cmd = ["arduino-cli", "compile", "--fqbn", fqbn,
+           "--library", os.path.join(ROOT, "SSBotMotor"),
+           "--library", os.path.join(ROOT, "SSBotSensor")]
+    if build_path:
+        cmd += ["--build-path", build_path]
+    result = subprocess.run(cmd + [sketch_dir], stdout=subprocess.PIPE,
+                            stderr=subprocess.STDOUT, universal_newlines=True)
+    if result.returncode != 0:
+        sys.stdout.write(result.stdout)
+        return None
+    return result.stdout
+
+
+def measure(sketch, fqbn):
+    output = compile_sketch(os.path.dirname(sketch), fqbn)
+    if output is None:
+        return None
+    flash = re.search(r"Sketch uses (\d+) bytes", output)
+    ram = re.search(r"Global variables use (\d+) bytes", output)
+    left = re.search(r"leaving (\d+) bytes for local variables", output)
+    return {"flash": int(flash.group(1)), "ram": int(ram.group(1)),
+            "stack": int(left.group(1)) if left else None}
+
+
+def class_budgets():
+    """{lowercase class name: bytes} from the *_SIZE_BUDGET constants in SSBotFootprint.hpp."""
+    values = {}
+    with open(FOOTPRINT_HEADER) as f:
+        for name, expr in re.findall(r"const size_t (\w+)\s*=\s*([^;]+);", f.read()):
+            values[name] = eval(expr, {}, values)  # e.g. "2 * MOTOR_SIZE_BUDGET + 5"
+    return {name[:-len("_SIZE_BUDGET")].replace("_", "").lower(): value
+            for name, value in values.items() if name.endswith("_SIZE_BUDGET")}
+
+
+def find_nm():
+    for pattern in (os.path.expanduser("~/.arduino15/packages/arduino/tools/avr-gcc/*/bin/avr-nm"),
+                    os.path.expanduser("~/Library/Arduino15/packages/arduino/tools/avr-gcc/*/bin/avr-nm"),
+                    os.path.expanduser("~/AppData/Local/Arduino15/packages/arduino/tools/avr-gcc/*/bin/avr-nm.exe")):
+        found = sorted(glob.glob(pattern))
+        if found:
+            return found[-1]
+    return "avr-nm"
+
+
+def measure_classes(fqbn, build_path, nm):
+    """{class name: sizeof} for the footprint_<Class> arrays in the probe."""
+    if compile_sketch(PROBE, fqbn, build_path) is None:
+        return None
+    elf = os.path.join(build_path, os.path.basename(PROBE) + ".ino.elf")
+    out = subprocess.run([nm, "-S", elf], stdout=subprocess.PIPE,
+                         universal_newlines=True, check=True).stdout
+    return {m.group(2): int(m.group(1), 16)
+            for m in re.finditer(r"^[0-9a-f]+ ([0-9a-f]+) \w footprint_(\w+)$", out, re.M)}
+
+
+def measure_stack(fqbn, build_path, port):
+    """Least stack the probe ever left unused while running, in bytes."""
+    subprocess.run(["arduino-cli", "upload", "--fqbn", fqbn, "--port", port,
+                    "--input-dir", build_path, PROBE], check=True)
+    import serial  # pip install pyserial
+    table = ssbot_log.load_table()
+    stack_id = [name for name, _ in table].index("LOG_STACK_UNUSED")
+    unused = None
+    with serial.Serial(port, ssbot_log.BAUD_RATE, timeout=0.2) as stream:
+        deadline = time.time() + STACK_SECONDS
+        for msg_id, args in ssbot_log.decode_frames(stream, table, until=deadline):
+            if msg_id == stack_id:
+                unused = args[0] if unused is None else min(unused, args[0])
+    return unused
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--fqbn", default="arduino:avr:uno")
+    parser.add_argument("--update", action="store_true", help="rewrite budgets from current sizes")
+    parser.add_argument("--port", help="upload the probe here and measure the stack")
+    parser.add_argument("--nm", default=find_nm(), help="path to avr-nm")
+    args = parser.parse_args()
+    if shutil.which("arduino-cli") is None:
+        sys.exit("footprint.py needs arduino-cli on the PATH (https://arduino.github.io/arduino-cli/)")
+
+    with open(BUDGET_FILE) as f:
+        budgets = json.load(f)
+    board = budgets.setdefault(args.fqbn, {})
+
+    failed = False
+    print("%-40s %8s %8s %8s   %s" % ("example", "flash", "RAM", "free", "budget (flash / RAM)"))
+    for sketch in examples():
+        name = os.path.relpath(sketch, ROOT).split(os.sep)
+        name = "%s/%s" % (name[0], name[2])
+        size = measure(sketch, args.fqbn)
+        if size is None:
+            print("%-40s  COMPILE FAILED" % name)
+            failed = True
+            continue
+
+        if args.update:
+            board[name] = {k: int(size[k] * HEADROOM) for k in ("flash", "ram")}
+        budget = board.get(name)
+        if budget is None:
+            status = "no budget recorded, not checked"
+        else:
+            over = [k for k in ("flash", "ram") if size[k] > budget[k]]
+            status = "%d / %d" % (budget["flash"], budget["ram"])
+            if over:
+                status += "   OVER BUDGET: " + ", ".join(over)
+                failed = True
+        print("%-40s %8d %8d %8s   %s" % (name, size["flash"], size["ram"],
+                                          size["stack"] if size["stack"] is not None else "?", status))
+
+    build_path = tempfile.mkdtemp(prefix="ssbot_probe_")
+    sizes = measure_classes(args.fqbn, build_path, args.nm)
+    print()
+    print("%-40s %8s %8s" % ("class", "sizeof", "budget"))
+    if sizes is None:
+        print("%-40s  COMPILE FAILED" % "tools/footprint_probe")
+        failed = True
+    else:
+        class_budget = class_budgets()
+        for cls in sorted(sizes):
+            if cls == "NewPing":
+                continue
+            size = sizes[cls]
+            if cls == "Sonar":  # its budget doesn't count the NewPing inside it
+                size -= sizes.get("NewPing", 0)
+                cls_name = "Sonar (+ NewPing)"
+            else:
+                cls_name = cls
+            budget = class_budget.get(cls.lower())
+            status = "" if budget is None or size <= budget else "   OVER BUDGET"
+            failed = failed or bool(status)
+            print("%-40s %8d %8s%s" % (cls_name, size, budget if budget is not None else "-", status))
+
+    print()
+    if args.port and sizes is not None:
+        unused = measure_stack(args.fqbn, build_path, args.port)
+        if unused is None:
+            print("stack high-water mark: no report from the probe on %s" % args.port)
+            failed = True
+        else:
+            status = "" if unused >= STACK_MARGIN else "   UNDER %d BYTE MARGIN" % STACK_MARGIN
+            failed = failed or bool(status)
+            print("stack high-water mark: %d bytes never used (probe on %s)%s" % (unused, args.port, status))
+    else:
+        print("stack high-water mark: run with --port to measure it on the robot")
+
+    if args.update:
+        with open(BUDGET_FILE, "w") as f:
+            json.dump(budgets, f, indent=2, sort_keys=True)
+            f.write("\n")
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,74 @@
+// Footprint probe for tools/footprint.py -- not an example to learn from.
+//
+// Compiled: each volatile footprint_<Class> array is exactly sizeof(Class) bytes,
+// so the class sizes can be read straight off the symbol table.
+// Uploaded (footprint.py --port): runs every library class's per-loop work and 
+// logs the stack high-water mark once a second.
+
+#include <SSBotMotor.hpp>
+#include <SSBotSensor.hpp>
+#include <SSBotScript.hpp>
+#include <SSBotGovernor.hpp>
+#include <SSBotLine.hpp>
+#include <SSBotBattery.hpp>
+#include <SSBotLog.hpp>
+#include <SSBotFootprint.hpp>
+
+using namespace SummerSpringBot;
+
+#define FOOTPRINT(type) volatile uint8_t footprint_##type[sizeof(type)];
+FOOTPRINT(Motor)
+FOOTPRINT(DualMotors)
+FOOTPRINT(DifferentialDrive)
+FOOTPRINT(Sonar)
+FOOTPRINT(NewPing)
+FOOTPRINT(IRSensor)
+FOOTPRINT(MotionScript)
+FOOTPRINT(SpeedGovernor)
+FOOTPRINT(LineSensorArray)
+FOOTPRINT(Battery)
+
+DifferentialDrive motors(11, 12, 10, 7, 8, 9);
+Sonar sonar(3, 4);
+IRSensor remote(2);
+SpeedGovernor governor(motors, sonar);
+MotionScript script(motors, sonar);
+const uint8_t linePins[] = {A0, A1, A2, A3, A4};
+LineSensorArray line(linePins, 5);
+Battery battery(A5);
+Logger logger(Serial);
+
+const MotionStep wander[] PROGMEM = {
+  MOTION_DRIVE(60, 1000), MOTION_TURN_LEFT(50, 300), MOTION_LOOP(0, 0), MOTION_END()
+};
+
+void setup() {
+  // touch the arrays so the linker keeps them
+  footprint_Motor[0] = footprint_DualMotors[0] = footprint_DifferentialDrive[0] = 0;
+  footprint_Sonar[0] = footprint_NewPing[0] = footprint_IRSensor[0] = 0;
+  footprint_MotionScript[0] = footprint_SpeedGovernor[0] = 0;
+  footprint_LineSensorArray[0] = footprint_Battery[0] = 0;
+
+  Serial.begin(115200);
+  motors.init();
+  sonar.init();
+  sonar.setRangeGating(true);
+  remote.init();
+  line.init();
+  battery.init();
+  script.run(wander);
+}
+
+void loop() {
+  static unsigned long lastReport = 0;
+  script.tick();
+  governor.update();
+  line.readLine();
+  battery.update();
+  if (IRSensor::isValid(remote.query()))
+    script.abort();
+  if (millis() - lastReport >= 1000) {
+    lastReport = millis();
+    logger.log(LOG_STACK_UNUSED, stackUnused());
+  }
+}
@@ -0,0 +1,169 @@
+#!/usr/bin/env python3
+"""
+ssbot_log.py - Decode the binary log stream sent by SummerSpringBot::Logger.
+
+The message table is generated from SSBOT_LOG_MESSAGES in SSBotMotor/src/SSBotLog.hpp,
+so new log messages only need to be added there.
+
+Usage:
+    python3 tools/ssbot_log.py --port /dev/ttyACM0      # live, needs pyserial
+    python3 tools/ssbot_log.py capture.bin              # from a saved capture
+    python3 tools/ssbot_log.py --table                  # print the message table
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+import time
+
+HEADER = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                      "..", "SSBotMotor", "src", "SSBotLog.hpp")
+SYNC_BYTE = 0xA5
+BAUD_RATE = 115200
+
+# These must match the enums in SSBotMotor.hpp and SSBotSensor.hpp.
+BUTTON_NAMES = {
+    -1: "ERROR", 0: "NONE",
+    1: "CH-", 2: "CH", 3: "CH+", 4: "<<", 5: ">>", 6: "PLAY",
+    7: "-", 8: "+", 9: "EQ", 10: "0", 11: "100+", 12: "200+",
+    13: "1", 14: "2", 15: "3", 16: "4", 17: "5", 18: "6", 19: "7", 20: "8", 21: "9",
+}
+STATE_NAMES = {
+    -1: "REVERSE", 0: "STOPPED", 1: "FORWARD", 2: "TURN_LEFT", 3: "TURN_RIGHT",
+    4: "ARC_LEFT", 5: "ARC_RIGHT",
+}
+CONVERSIONS = {
+    "d": str,
+    "button": lambda v: BUTTON_NAMES.get(v, "?%d" % v),
+    "state": lambda v: STATE_NAMES.get(v, "?%d" % v),
+    "enabled": lambda v: "ENABLED" if v else "DISABLED",
+}
+
+
+def load_table(header=HEADER):
+    """Return [(name, format)] indexed by message ID."""
+    with open(header) as f:
+        text = f.read()
+    block = re.search(r"#define SSBOT_LOG_MESSAGES\(X\)(.*?)\n\s*\n", text, re.S).group(1)
+    return re.findall(r'X\(\s*(\w+)\s*,\s*"((?:[^"\\]|\\.)*)"\s*\)', block)
+
+
+def load_max_args(header=HEADER):
+    with open(header) as f:
+        return int(re.search(r"LOG_MAX_ARGS\s*=\s*(\d+)", f.read()).group(1))
+
+
+def crc8(data):
+    """CRC-8, polynomial 0x07 -- same as SummerSpringBot::crc8()."""
+    crc = 0
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def format_message(table, msg_id, args):
+    if msg_id >= len(table):
+        return "<unknown message %d %s>" % (msg_id, args)
+    name, fmt = table[msg_id]
+    args = iter(args)
+
+    def substitute(match):
+        value = next(args, None)
+        if value is None:
+            return "<missing>"
+        if match.group(1) == "u32":
+            high = next(args, None)
+            if high is None:
+                return "<missing>"
+            return str((value & 0xFFFF) | (high & 0xFFFF) << 16)
+        return CONVERSIONS.get(match.group(1), str)(value)
+
+    return re.sub(r"\{(\w+)\}", substitute, fmt)
+
+
+def decode_frames(stream, table, max_args=None, until=None):
+    """Yield (message ID, args) for each frame in a byte stream.
+
+    Bytes can go missing mid-frame (the Arduino drops output when its buffer is
+    full), so a SYNC byte may really be an argument byte. A frame is only accepted
+    if its id and argc are plausible and its CRC matches; otherwise the decoder
+    resyncs one byte after the SYNC it tried. With `until` (a time.time() deadline),
+    empty reads are read timeouts rather than the end of the stream.
+    """
+    if max_args is None:
+        max_args = load_max_args()
+    buf = bytearray()
+
+    def fill(n):
+        while len(buf) < n:
+            chunk = stream.read(n - len(buf))
+            if not chunk and (until is None or time.time() >= until):
+                return False
+            buf.extend(chunk)
+        return True
+
+    while True:
+        if not fill(3):
+            return
+        if buf[0] != SYNC_BYTE:
+            del buf[0]
+            continue
+        msg_id, argc = buf[1], buf[2]
+        if msg_id >= len(table) or argc > max_args:
+            del buf[0]
+            continue
+        size = 4 + 2 * argc
+        if not fill(size):
+            return
+        if crc8(buf[1:size - 1]) != buf[size - 1]:
+            del buf[0]
+            continue
+        args = struct.unpack("<%dh" % argc, bytes(buf[3:size - 1]))
+        del buf[:size]
+        yield msg_id, args
+
+
+def decode(stream, table, max_args=None):
+    """Yield decoded lines from a byte stream."""
+    for msg_id, args in decode_frames(stream, table, max_args):
+        yield format_message(table, msg_id, args)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("capture", nargs="?", help="binary capture file (default: stdin)")
+    parser.add_argument("--port", help="serial port to read from")
+    parser.add_argument("--baud", type=int, default=BAUD_RATE)
+    parser.add_argument("--header", default=HEADER, help="path to SSBotLog.hpp")
+    parser.add_argument("--table", action="store_true", help="print message table and exit")
+    args = parser.parse_args()
+
+    table = load_table(args.header)
+    max_args = load_max_args(args.header)
+    if args.table:
+        for msg_id, (name, fmt) in enumerate(table):
+            print("%3d  %-28s %s" % (msg_id, name, fmt))
+        return
+
+    if args.port:
+        import serial  # pip install pyserial
+        stream = serial.Serial(args.port, args.baud)
+    elif args.capture:
+        stream = open(args.capture, "rb")
+    else:
+        stream = sys.stdin.buffer
+
+    try:
+        for line in decode(stream, table, max_args):
+            print(line, flush=True)
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()